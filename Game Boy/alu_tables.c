@@ -0,0 +1,170 @@
+#include "gameboy.h"
+#include "instructions.h"
+#include "flags.h"
+#include "threads.h"
+
+#if FLAG_MODE == FLAGS_TABLE
+
+/*  ALU lookup tables
+    Every 8-bit ALU instruction is one table load. Each entry holds the result in the high byte
+    and the flags in the low byte, worked out exactly as the eager helpers in instructions.c do.
+    The tables are shared by all instances and never change once built. They are built under a lock
+    the first time an instance is created, so instances can be created on any thread.
+*/
+
+#define Z_FLAG (1 << FLAG_Z)
+#define N_FLAG (1 << FLAG_N)
+#define H_FLAG (1 << FLAG_H)
+#define C_FLAG (1 << FLAG_C)
+
+static WORD add_table[2][256][256];    // [carry in][A][n], ADD and ADC
+static WORD sub_table[2][256][256];    // [carry in][A][n], SUB, SBC and CP
+static WORD inc_table[256];            // Flags without C, INC keeps it
+static WORD dec_table[256];            // Flags without C, DEC keeps it
+static BYTE logic_table[256];          // Z flag of an AND, OR or XOR result
+static WORD daa_table[16][256];        // [F >> 4][A]
+static int tables_built = 0;
+static MUTEX tables_lock = MUTEX_INIT;
+
+static WORD entry(int result, BYTE flags) {
+    if ((BYTE)result == 0)
+        flags |= Z_FLAG;
+    return ((BYTE)result << 8) | flags;
+}
+
+static WORD daa_entry(BYTE a, BYTE f) {
+    BYTE n = 0x00;
+
+    if (!(f & N_FLAG)) {
+        if (a > 0x99 || (f & C_FLAG)) {
+            f |= C_FLAG;
+            n |= 0x60;
+        }
+        if ((a & 0x0F) > 0x09 || (f & H_FLAG)) {
+            n |= 0x06;
+        }
+    }
+    else {
+        if ((f & C_FLAG) && !(f & H_FLAG))
+            n |= 0xA0;
+        if (f & H_FLAG)
+            n |= (f & C_FLAG) ? 0x9A : 0xFA;
+    }
+
+    a += n;
+    f &= ~(Z_FLAG | H_FLAG);
+    return entry(a, f);
+}
+
+static void build_tables(void) {
+    for (int carry = 0; carry < 2; carry++) {
+        for (int a = 0; a < 256; a++) {
+            for (int n = 0; n < 256; n++) {
+                BYTE flags = 0x00;
+                if (a + n + carry > 0xFF)
+                    flags |= C_FLAG;
+                if ((a & 0x0F) + (n & 0x0F) + carry > 0x0F)
+                    flags |= H_FLAG;
+                add_table[carry][a][n] = entry(a + n + carry, flags);
+
+                flags = N_FLAG;
+                if (a - n - carry < 0)
+                    flags |= C_FLAG;
+                if ((a & 0x0F) - (n & 0x0F) - carry < 0)
+                    flags |= H_FLAG;
+                sub_table[carry][a][n] = entry(a - n - carry, flags);
+            }
+        }
+    }
+
+    for (int n = 0; n < 256; n++) {
+        inc_table[n] = entry(n + 1, (n & 0x0F) == 0x0F ? H_FLAG : 0);
+        dec_table[n] = entry(n - 1, N_FLAG | ((n & 0x0F) == 0 ? H_FLAG : 0));
+        logic_table[n] = n == 0 ? Z_FLAG : 0;
+    }
+
+    for (int f = 0; f < 16; f++) {
+        for (int a = 0; a < 256; a++) {
+            daa_table[f][a] = daa_entry(a, f << 4);
+        }
+    }
+}
+
+void alu_tables_init(void) {
+    mutex_lock(&tables_lock);
+    if (!tables_built) {
+        build_tables();
+        tables_built = 1;
+    }
+    mutex_unlock(&tables_lock);
+}
+
+static void set_result(GameBoy *gb, WORD value) {
+    gb->RegAF.hi = value >> 8;
+    gb->RegAF.lo = value & 0xFF;
+}
+
+void cpu_add(GameBoy *gb, BYTE n) {
+    set_result(gb, add_table[0][gb->RegAF.hi][n]);
+}
+
+void cpu_adc(GameBoy *gb, BYTE n) {
+    set_result(gb, add_table[(gb->RegAF.lo >> FLAG_C) & 1][gb->RegAF.hi][n]);
+}
+
+void cpu_sub(GameBoy *gb, BYTE n) {
+    set_result(gb, sub_table[0][gb->RegAF.hi][n]);
+}
+
+void cpu_sbc(GameBoy *gb, BYTE n) {
+    set_result(gb, sub_table[(gb->RegAF.lo >> FLAG_C) & 1][gb->RegAF.hi][n]);
+}
+
+void cpu_and(GameBoy *gb, BYTE n) {
+    gb->RegAF.hi &= n;
+    gb->RegAF.lo = logic_table[gb->RegAF.hi] | H_FLAG;
+}
+
+void cpu_or(GameBoy *gb, BYTE n) {
+    gb->RegAF.hi |= n;
+    gb->RegAF.lo = logic_table[gb->RegAF.hi];
+}
+
+void cpu_xor(GameBoy *gb, BYTE n) {
+    gb->RegAF.hi ^= n;
+    gb->RegAF.lo = logic_table[gb->RegAF.hi];
+}
+
+void cpu_cp(GameBoy *gb, BYTE n) {
+    gb->RegAF.lo = sub_table[0][gb->RegAF.hi][n] & 0xFF;
+}
+
+BYTE cpu_inc(GameBoy *gb, BYTE n) {
+    WORD value = inc_table[n];
+    gb->RegAF.lo = (gb->RegAF.lo & C_FLAG) | (value & 0xFF);
+    return value >> 8;
+}
+
+void cpu_inc_hl(GameBoy *gb, WORD address) {
+    WORD value = inc_table[read_memory(gb, address)];
+    write_memory(gb, address, value >> 8);
+    gb->RegAF.lo = (gb->RegAF.lo & C_FLAG) | (value & 0xFF);
+}
+
+BYTE cpu_dec(GameBoy *gb, BYTE n) {
+    WORD value = dec_table[n];
+    gb->RegAF.lo = (gb->RegAF.lo & C_FLAG) | (value & 0xFF);
+    return value >> 8;
+}
+
+void cpu_dec_hl(GameBoy *gb, WORD address) {
+    WORD value = dec_table[read_memory(gb, address)];
+    write_memory(gb, address, value >> 8);
+    gb->RegAF.lo = (gb->RegAF.lo & C_FLAG) | (value & 0xFF);
+}
+
+void cpu_daa(GameBoy *gb) {
+    set_result(gb, daa_table[gb->RegAF.lo >> 4][gb->RegAF.hi]);
+}
+
+#endif
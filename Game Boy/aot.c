@@ -0,0 +1,490 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gameboy.h"
+#include "emulator.h"
+#include "aot.h"
+#include "opcodes.h"
+
+/*  Static recompilation
+    aot_translate() follows the control flow of a ROM from 0x100 and the interrupt vectors 0x40-0x60,
+    and every jump, call and RST target it can work out from the code itself, and writes one C
+    function per block. A block starts at a jump target or after a jump, call, return, RST, HALT or
+    STOP, and ends at the next one of those, at the start of another block or after AOT_MAX_OPS
+    instructions. Each instruction is written as C by write_instruction(), by hand and not from
+    opcodes.txt: loads, stores and register moves become assignments and read_memory() and
+    write_memory() calls with the operands filled in as constants, and everything else calls the same
+    helpers in instructions.c the interpreter does. It is charged the cycles in opcode_cycles, which
+    the handlers return. A change to an instruction in opcodes.txt has to be made in
+    write_instruction() as well.
+
+    Only banks 0 and 1 are translated, as they are mapped at power on, and no block runs on from
+    0000-3FFF into 4000-7FFF. At run time a block only runs if it starts at PC, its page is mapped
+    where it was translated from, and all of it fits before stop_cycle. Anything else, such as the
+    target of JP (HL) or RET that was never found statically, code in another bank or in RAM, or a
+    block that would run past the next event, is left to the interpreter. An instruction that touches
+    memory or the interrupt flags can schedule an event that lowers stop_cycle into the block, so the
+    block returns after it if it did, and the interpreter runs the rest. A write that switches the ROM
+    bank lowers stop_cycle as well (mbc.c), so a bank 1 block that switches its own bank returns at the
+    write rather than running on through instructions that are no longer mapped.
+*/
+
+#define AOT_MAX_OPS 32
+#define ROM_END 0x8000
+#define BANK_START 0x4000
+
+static const char *reg_name[8] = {
+    "gb->RegBC.hi", "gb->RegBC.lo", "gb->RegDE.hi", "gb->RegDE.lo",
+    "gb->RegHL.hi", "gb->RegHL.lo", NULL, "gb->RegAF.hi"
+};
+
+static const char *pair_name[4] = { "gb->RegBC", "gb->RegDE", "gb->RegHL", "gb->RegSP" };
+static const char *condition_name[4] = { "NZ", "Z", "NC", "C" };
+static const char *alu_name[8] = { "add", "adc", "sub", "sbc", "and", "xor", "or", "cp" };
+static const char *shift_name[8] = { "rlc", "rrc", "rl", "rr", "sla", "sra", "swap", "srl" };
+
+static unsigned long long hash_rom(const BYTE *rom) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (int i = 0; i < ROM_END; i++) {
+        hash ^= rom[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/* Number of cycles the interpreter takes for the instruction */
+static int instruction_cycles(const BYTE *rom, WORD pc) {
+    BYTE opcode = rom[pc];
+    return opcode == 0xCB ? cb_opcode_cycles[rom[(WORD)(pc + 1)]] : opcode_cycles[opcode];
+}
+
+/* 1 if the instruction can change PC or stop the CPU, 2 if execution never falls through it */
+static int ends_block(BYTE opcode) {
+    switch (opcode) {
+    case 0x18: case 0xC3: case 0xE9: case 0xC9: case 0xD9:
+        return 2;
+    case 0x20: case 0x28: case 0x30: case 0x38:
+    case 0xC2: case 0xCA: case 0xD2: case 0xDA:
+    case 0xC4: case 0xCC: case 0xCD: case 0xD4: case 0xDC:
+    case 0xC0: case 0xC8: case 0xD0: case 0xD8:
+    case 0xC7: case 0xCF: case 0xD7: case 0xDF: case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+    case 0x76: case 0x10:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* Jump, call or RST target of the instruction, or -1 if it has none that is known before it runs */
+static int branch_target(const BYTE *rom, WORD pc) {
+    BYTE opcode = rom[pc];
+    switch (opcode) {
+    case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+        return (WORD)(pc + 2 + (SIGNED_BYTE)rom[pc + 1]);
+    case 0xC2: case 0xC3: case 0xCA: case 0xD2: case 0xDA:
+    case 0xC4: case 0xCC: case 0xCD: case 0xD4: case 0xDC:
+        return rom[pc + 1] | (rom[pc + 2] << 8);
+    case 0xC7: case 0xCF: case 0xD7: case 0xDF: case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+        return opcode - 0xC7;
+    default:
+        return -1;
+    }
+}
+
+/* 1 if the instruction only works on registers, so it cannot schedule an event or switch banks */
+static int registers_only(const BYTE *rom, WORD pc) {
+    BYTE opcode = rom[pc];
+    if (opcode == 0xCB)
+        return (rom[(WORD)(pc + 1)] & 0x07) != 6;
+    if (opcode >= 0x40 && opcode < 0x80)
+        return opcode != 0x76 && (opcode & 0x07) != 6 && ((opcode >> 3) & 0x07) != 6;
+    if (opcode >= 0x80 && opcode < 0xC0)
+        return (opcode & 0x07) != 6;
+    if (opcode < 0x40 && ((opcode & 0x07) == 0x04 || (opcode & 0x07) == 0x05 || (opcode & 0x07) == 0x06))
+        return ((opcode >> 3) & 0x07) != 6;     // INC r, DEC r, LD r,n
+    switch (opcode & 0xCF) {
+    case 0x01: case 0x03: case 0x09: case 0x0B:     // LD rr,nn, INC rr, ADD HL,rr, DEC rr
+        return 1;
+    }
+    switch (opcode) {
+    case 0x00: case 0x07: case 0x0F: case 0x17: case 0x1F: case 0x27: case 0x2F: case 0x37: case 0x3F:
+    case 0xC6: case 0xCE: case 0xD6: case 0xDE: case 0xE6: case 0xEE: case 0xF6: case 0xFE:
+    case 0xE8: case 0xF8: case 0xF9:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static int in_rom(int address, BYTE opcode) {
+    return address >= 0 && address + opcode_lengths[opcode] <= ROM_END;
+}
+
+/* Mark every block start reachable from the entry points */
+static void find_blocks(const BYTE *rom, BYTE *is_block) {
+    static const WORD entries[] = { 0x100, 0x40, 0x48, 0x50, 0x58, 0x60 };
+    WORD *pending = malloc(ROM_END * sizeof(WORD));
+    BYTE *visited = calloc(ROM_END, 1);
+    int count = 0;
+    if (pending == NULL || visited == NULL) {
+        free(pending);
+        free(visited);
+        return;
+    }
+    for (size_t i = 0; i < sizeof(entries) / sizeof(entries[0]); i++) {
+        is_block[entries[i]] = 1;
+        pending[count++] = entries[i];
+    }
+
+    while (count > 0) {
+        int pc = pending[--count];
+        while (in_rom(pc, rom[pc]) && !visited[pc]) {
+            visited[pc] = 1;
+            BYTE opcode = rom[pc];
+            int next = pc + opcode_lengths[opcode];
+            int target = branch_target(rom, (WORD)pc);
+            if (target >= 0 && target < ROM_END && !is_block[target]) {
+                is_block[target] = 1;
+                pending[count++] = (WORD)target;
+            }
+            if (ends_block(opcode) == 2)
+                break;
+            if (ends_block(opcode) == 1 && next < ROM_END && !is_block[next])
+                is_block[next] = 1;
+            pc = next;
+        }
+    }
+
+    // Split blocks that are too long. The block after a split is always further on, so one pass will do
+    for (int start = 0; start < ROM_END; start++) {
+        if (!is_block[start])
+            continue;
+        int pc = start;
+        for (int ops = 0; in_rom(pc, rom[pc]); ops++) {
+            if (pc != start && is_block[pc])
+                break;
+            if (ops == AOT_MAX_OPS || (pc == BANK_START && pc != start)) {
+                is_block[pc] = 1;
+                break;
+            }
+            if (ends_block(rom[pc]))
+                break;
+            pc += opcode_lengths[rom[pc]];
+        }
+    }
+    free(pending);
+    free(visited);
+}
+
+/* Write the C for one instruction */
+static void write_instruction(FILE *out, const BYTE *rom, WORD pc) {
+    BYTE opcode = rom[pc];
+    BYTE n = rom[(WORD)(pc + 1)];
+    WORD nn = n | (rom[(WORD)(pc + 2)] << 8);
+    WORD next = pc + opcode_lengths[opcode];
+    const char *dst = reg_name[(opcode >> 3) & 0x07];
+    const char *src = reg_name[opcode & 0x07];
+    const char *pair = pair_name[(opcode >> 4) & 0x03];
+    const char *stack_pair = (opcode >> 4) == 0x0F ? "gb->RegAF" : pair;
+    const char *condition = condition_name[(opcode >> 3) & 0x03];
+
+    fprintf(out, "    /* %04X */ ", pc);
+
+    if (opcode >= 0x40 && opcode < 0x80 && opcode != 0x76) {
+        if (dst == NULL) {
+            fprintf(out, "write_memory(gb, gb->RegHL.data, %s);\n", src);
+            return;
+        }
+        if (src == NULL) {
+            fprintf(out, "%s = read_memory(gb, gb->RegHL.data);\n", dst);
+            return;
+        }
+        fprintf(out, "%s = %s;\n", dst, src);
+        return;
+    }
+    if (opcode >= 0x80 && opcode < 0xC0) {
+        const char *op = alu_name[(opcode >> 3) & 0x07];
+        int cp = ((opcode >> 3) & 0x07) == 7;
+        if (src == NULL && cp)
+            fprintf(out, "cpu_cp(gb, MEMORY_AT(gb, gb->RegHL.data));\n");
+        else if (src == NULL)
+            fprintf(out, "cpu_%s(gb, read_memory(gb, gb->RegHL.data));\n", op);
+        else if (cp)
+            fprintf(out, "cpu_cp(gb, %s);\n", src);
+        else
+            fprintf(out, "cpu_%s(gb, %s);\n", op, src);
+        return;
+    }
+    if ((opcode & 0xC7) == 0xC6) {
+        const char *op = alu_name[(opcode >> 3) & 0x07];
+        if (opcode == 0xFE)
+            fprintf(out, "cpu_cp(gb, 0x%02X);\n", n);
+        else
+            fprintf(out, "cpu_%s(gb, 0x%02X);\n", op, n);
+        return;
+    }
+    if ((opcode & 0xC7) == 0x06) {
+        if (dst == NULL) {
+            fprintf(out, "write_memory(gb, gb->RegHL.data, 0x%02X);\n", n);
+            return;
+        }
+        fprintf(out, "%s = 0x%02X;\n", dst, n);
+        return;
+    }
+    if ((opcode & 0xC7) == 0x04 || (opcode & 0xC7) == 0x05) {
+        const char *op = (opcode & 0x01) ? "dec" : "inc";
+        if (dst == NULL) {
+            fprintf(out, "cpu_%s_hl(gb, gb->RegHL.data);\n", op);
+            return;
+        }
+        fprintf(out, "%s = cpu_%s(gb, %s);\n", dst, op, dst);
+        return;
+    }
+    if ((opcode & 0xC7) == 0xC7) {
+        fprintf(out, "gb->PC = 0x%04X; cpu_rst(gb, 0x%02X);\n", next, opcode - 0xC7);
+        return;
+    }
+
+    switch (opcode) {
+    case 0x00:
+        fprintf(out, "/* NOP */\n");
+        return;
+    case 0x0A: case 0x1A:
+        fprintf(out, "gb->RegAF.hi = read_memory(gb, %s.data);\n", pair);
+        return;
+    case 0x02: case 0x12:
+        fprintf(out, "write_memory(gb, %s.data, gb->RegAF.hi);\n", pair);
+        return;
+    case 0xFA:
+        fprintf(out, "gb->RegAF.hi = read_memory(gb, 0x%04X);\n", nn);
+        return;
+    case 0xEA:
+        fprintf(out, "write_memory(gb, 0x%04X, gb->RegAF.hi);\n", nn);
+        return;
+    case 0xF2:
+        fprintf(out, "gb->RegAF.hi = read_memory(gb, 0xFF00 + gb->RegBC.lo);\n");
+        return;
+    case 0xE2:
+        fprintf(out, "write_memory(gb, 0xFF00 + gb->RegBC.lo, gb->RegAF.hi);\n");
+        return;
+    case 0x2A: case 0x3A:
+        fprintf(out, "gb->RegAF.hi = read_memory(gb, gb->RegHL.data); gb->RegHL.data%s;\n", opcode == 0x2A ? "++" : "--");
+        return;
+    case 0x22: case 0x32:
+        fprintf(out, "write_memory(gb, gb->RegHL.data, gb->RegAF.hi); gb->RegHL.data%s;\n", opcode == 0x22 ? "++" : "--");
+        return;
+    case 0xE0:
+        fprintf(out, "write_memory(gb, 0x%04X, gb->RegAF.hi);\n", 0xFF00 + n);
+        return;
+    case 0xF0:
+        fprintf(out, "gb->RegAF.hi = read_memory(gb, 0x%04X);\n", 0xFF00 + n);
+        return;
+    case 0x01: case 0x11: case 0x21: case 0x31:
+        fprintf(out, "%s.data = 0x%04X;\n", pair, nn);
+        return;
+    case 0xF9:
+        fprintf(out, "gb->RegSP.data = gb->RegHL.data;\n");
+        return;
+    case 0xF8:
+        fprintf(out, "gb->PC = 0x%04X; LDHL_SP_n(gb);\n", (WORD)(pc + 1));
+        return;
+    case 0x08:
+        fprintf(out, "cpu_loadRegSP(gb, 0x%04X, &gb->RegSP);\n", nn);
+        return;
+    case 0xC5: case 0xD5: case 0xE5: case 0xF5:
+        fprintf(out, "stack_push(gb, &%s.hi, &%s.lo);\n", stack_pair, stack_pair);
+        return;
+    case 0xC1: case 0xD1: case 0xE1: case 0xF1:
+        fprintf(out, "stack_pop(gb, &%s.hi, &%s.lo);\n", stack_pair, stack_pair);
+        return;
+    case 0x09: case 0x19: case 0x29: case 0x39:
+        fprintf(out, "cpu_add16(gb, &gb->RegHL.data, &%s.data);\n", pair);
+        return;
+    case 0xE8:
+        fprintf(out, "gb->PC = 0x%04X; cpu_add_sp_n(gb);\n", (WORD)(pc + 1));
+        return;
+    case 0x03: case 0x13: case 0x23: case 0x33:
+        fprintf(out, "%s.data++;\n", pair);
+        return;
+    case 0x0B: case 0x1B: case 0x2B: case 0x3B:
+        fprintf(out, "%s.data--;\n", pair);
+        return;
+    case 0x27: fprintf(out, "cpu_daa(gb);\n"); return;
+    case 0x2F: fprintf(out, "cpu_cpl(gb);\n"); return;
+    case 0x3F: fprintf(out, "cpu_ccf(gb);\n"); return;
+    case 0x37: fprintf(out, "cpu_scf(gb);\n"); return;
+    case 0x07: fprintf(out, "cpu_rlca(gb);\n"); return;
+    case 0x17: fprintf(out, "cpu_rla(gb);\n"); return;
+    case 0x0F: fprintf(out, "cpu_rrca(gb);\n"); return;
+    case 0x1F: fprintf(out, "cpu_rra(gb);\n"); return;
+    case 0xF3: fprintf(out, "cpu_ei(gb, 0);\n"); return;
+    case 0xFB: fprintf(out, "cpu_ei(gb, 1);\n"); return;
+    case 0x76:
+        fprintf(out, "gb->PC = 0x%04X; cpu_halt(gb);\n", next);
+        return;
+    case 0x10:
+        fprintf(out, "gb->PC = 0x%04X; cpu_stop(gb);\n", next);
+        return;
+    case 0xC3:
+        fprintf(out, "gb->PC = 0x%04X; cpu_jump(gb, NONE);\n", (WORD)(pc + 1));
+        return;
+    case 0xC2: case 0xCA: case 0xD2: case 0xDA:
+        fprintf(out, "gb->PC = 0x%04X; cpu_jump(gb, %s);\n", (WORD)(pc + 1), condition);
+        return;
+    case 0xE9:
+        fprintf(out, "gb->PC = gb->RegHL.data;\n");
+        return;
+    case 0x18:
+        fprintf(out, "gb->PC = 0x%04X; cpu_jr(gb, NONE);\n", (WORD)(pc + 1));
+        return;
+    case 0x20: case 0x28: case 0x30: case 0x38:
+        fprintf(out, "gb->PC = 0x%04X; cpu_jr(gb, %s);\n", (WORD)(pc + 1), condition);
+        return;
+    case 0xCD:
+        fprintf(out, "gb->PC = 0x%04X; cpu_call(gb, NONE);\n", (WORD)(pc + 1));
+        return;
+    case 0xC4: case 0xCC: case 0xD4: case 0xDC:
+        fprintf(out, "gb->PC = 0x%04X; cpu_call(gb, %s);\n", (WORD)(pc + 1), condition);
+        return;
+    case 0xC9:
+        fprintf(out, "cpu_ret(gb, NONE);\n");
+        return;
+    case 0xC0: case 0xC8: case 0xD0: case 0xD8:
+        fprintf(out, "gb->PC = 0x%04X; cpu_ret(gb, %s);\n", next, condition);
+        return;
+    case 0xD9:
+        fprintf(out, "cpu_reti(gb);\n");
+        return;
+    case 0xCB:
+        break;
+    default:
+        fprintf(out, "/* Invalid opcode %02X */\n", opcode);
+        return;
+    }
+
+    // CB prefix
+    const char *reg = reg_name[n & 0x07];
+    BYTE bit = (n >> 3) & 0x07;
+    switch (n >> 6) {
+    case 0:
+        if (reg == NULL)
+            fprintf(out, "cpu_%s_hl(gb, gb->RegHL.data);\n", shift_name[bit]);
+        else
+            fprintf(out, "cpu_%s(gb, &%s);\n", shift_name[bit], reg);
+        break;
+    case 1:
+        if (reg == NULL)
+            fprintf(out, "{ BYTE n = read_memory(gb, gb->RegHL.data); cpu_test_bit(gb, %d, &n); }\n", bit);
+        else
+            fprintf(out, "cpu_test_bit(gb, %d, &%s);\n", bit, reg);
+        break;
+    default:
+        if (reg == NULL)
+            fprintf(out, "cpu_%s_bit_hl(gb, %d, gb->RegHL.data);\n", (n >> 6) == 2 ? "reset" : "set", bit);
+        else
+            fprintf(out, "cpu_%s_bit(%d, &%s);\n", (n >> 6) == 2 ? "reset" : "set", bit, reg);
+        break;
+    }
+}
+
+/* Write the function for the block at start. Returns the cycles of every instruction but the last */
+static int write_block(FILE *out, const BYTE *rom, const BYTE *is_block, WORD start) {
+    int body_cycles = 0;
+    int cycles = 0;
+    WORD pc = start;
+    WORD last = start;
+
+    fprintf(out, "static WORD block_%04X(GameBoy *gb, unsigned long long fit) {\n", start);
+    for (int ops = 0; in_rom(pc, rom[pc]) && ops < AOT_MAX_OPS; ops++) {
+        if (pc != start && is_block[pc])
+            break;
+        // Return to the interpreter if the instruction before lowered stop_cycle into the block
+        if (pc != start && !registers_only(rom, last))
+            fprintf(out, "    if (gb->stop_cycle <= fit) { gb->PC = 0x%04X; return 0x%04X; }\n", pc, last);
+        body_cycles += cycles;
+        cycles = instruction_cycles(rom, pc);
+        write_instruction(out, rom, pc);
+        if (cycles != 0)
+            fprintf(out, "    gb->total_cycles += %d;\n", cycles);
+        last = pc;
+        pc += opcode_lengths[rom[pc]];
+        if (ends_block(rom[last]))
+            break;
+    }
+    if (!ends_block(rom[last]))
+        fprintf(out, "    gb->PC = 0x%04X;\n", pc);
+    fprintf(out, "    return 0x%04X;\n}\n\n", last);
+    return body_cycles;
+}
+
+int aot_translate(char *filename, const char *output) {
+    GameBoy *gb = create_gameboy();
+    if (gb == NULL || power_on(gb, filename) == 1) {
+        destroy_gameboy(gb);
+        return 1;
+    }
+    BYTE *is_block = calloc(ROM_END, 1);
+    int *body_cycles = calloc(ROM_END, sizeof(int));
+    FILE *out;
+    if (is_block == NULL || body_cycles == NULL || fopen_s(&out, output, "w") != 0) {
+        free(is_block);
+        free(body_cycles);
+        destroy_gameboy(gb);
+        return 1;
+    }
+
+    const BYTE *rom = gb->cartridge_memory;
+    find_blocks(rom, is_block);
+
+    fprintf(out, "/* Generated by Game Boy.exe --aot from %s. Do not edit.\n", filename);
+    fprintf(out, "   Add this file to the build and set AOT to 1 in cpu.h */\n");
+    fprintf(out, "#include \"gameboy.h\"\n#include \"instructions.h\"\n#include \"memory_map.h\"\n#include \"aot.h\"\n\n");
+    fprintf(out, "#if AOT\n\n");
+    for (int pc = 0; pc < ROM_END; pc++) {
+        if (is_block[pc])
+            body_cycles[pc] = write_block(out, rom, is_block, (WORD)pc);
+    }
+
+    int count = 0;
+    fprintf(out, "static const AotBlock blocks[] = {\n");
+    for (int pc = 0; pc < ROM_END; pc++) {
+        if (is_block[pc])
+            fprintf(out, "    { block_%04X, %d },\n", pc, body_cycles[pc]);
+    }
+    fprintf(out, "};\n\nstatic const unsigned short block_index[0x8000] = {\n");
+    for (int pc = 0; pc < ROM_END; pc++) {
+        if (is_block[pc])
+            fprintf(out, "    [0x%04X] = %d,\n", pc, ++count);
+    }
+    fprintf(out, "};\n\nconst AotProgram aot_program = { 0x%016llXULL, block_index, blocks };\n\n#endif\n",
+        hash_rom(rom));
+
+    int failed = ferror(out);
+    fclose(out);
+    free(is_block);
+    free(body_cycles);
+    destroy_gameboy(gb);
+    return failed != 0;
+}
+
+void aot_attach(GameBoy *gb) {
+#if AOT
+    gb->aot = gb->cartridge_memory != NULL && hash_rom(gb->cartridge_memory) == aot_program.rom_hash ? &aot_program : NULL;
+#else
+    gb->aot = NULL;
+#endif
+}
+
+int aot_run_block(GameBoy *gb) {
+    const AotProgram *program = gb->aot;
+    if (program == NULL || gb->PC >= ROM_END || program->index[gb->PC] == 0)
+        return -1;
+    // Another bank is selected
+    if (gb->memory_page[gb->PC >> 8] != gb->cartridge_memory + (gb->PC & 0xFF00))
+        return -1;
+    const AotBlock *block = &program->blocks[program->index[gb->PC] - 1];
+    unsigned long long fit = gb->total_cycles + block->body_cycles;
+    if (fit >= gb->stop_cycle)
+        return -1;
+    return block->run(gb, fit);
+}
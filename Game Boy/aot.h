@@ -0,0 +1,38 @@
+#ifndef AOT_H
+#define AOT_H
+#include "cpu.h"
+
+/* One block of a translated ROM. Runs the instructions in the block, adding their cycles to
+   total_cycles, and returns the address of the last instruction it ran. fit is total_cycles at the
+   start of the last instruction, and the block returns early if an instruction lowers stop_cycle to it */
+typedef WORD (*AOT_FUNCTION)(GameBoy *gb, unsigned long long fit);
+
+typedef struct {
+    AOT_FUNCTION run;
+    unsigned short body_cycles; // Cycles of every instruction but the last
+} AotBlock;
+
+/* A ROM translated to C by aot_translate() */
+typedef struct AotProgram {
+    unsigned long long rom_hash;    // Hash of 0000-7FFF of the ROM it was translated from
+    const unsigned short *index;    // 0x8000 entries, the block starting at each address plus one, or 0
+    const AotBlock *blocks;
+} AotProgram;
+
+#if AOT
+/* Defined by the translation unit aot_translate() wrote, which has to be added to the build */
+extern const AotProgram aot_program;
+#endif
+
+/* Walk the code reachable from 0x100 and the interrupt vectors of the ROM and write it out as C.
+   Returns 1 if the ROM could not be loaded or the output could not be written */
+int aot_translate(char *filename, const char *output);
+
+/* Use the translated program for this instance if it was made from the ROM that is loaded */
+void aot_attach(GameBoy *gb);
+
+/* Run the translated block at PC if there is one and all of it fits before stop_cycle.
+   Returns the address of the last instruction run, or -1 if there is no block to run */
+int aot_run_block(GameBoy *gb);
+
+#endif
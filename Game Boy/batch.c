@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "gameboy.h"
+#include "emulator.h"
+#include "batch.h"
+
+#include "threads.h"
+
+/*  Work stealing
+    Each round runs one frame of every instance. The instances are split into one contiguous
+    range per worker. A worker takes instances from the front of its own range, and once that
+    is empty it takes from the other workers' ranges. Taking an instance is a single atomic
+    increment of the range's next index, so an instance is never run twice in a round.
+*/
+typedef struct {
+    volatile long next;
+    long end;
+    char pad[64 - sizeof(long) * 2];    // Keep each worker's range on its own cache line
+} WorkQueue;
+
+typedef struct {
+    BatchInstance *instances;
+    WorkQueue *queues;
+    int workers;
+
+    MUTEX lock;
+    CONDITION_VAR start;        // Signalled when a new round begins
+    CONDITION_VAR done;         // Signalled when the last worker finishes a round
+    unsigned int round;
+    int pending;                // Workers still running the current round
+    int quit;
+} ThreadPool;
+
+typedef struct {
+    ThreadPool *pool;
+    int id;
+} Worker;
+
+static int processor_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+#endif
+}
+
+static double seconds_now(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static void run_queue(ThreadPool *pool, WorkQueue *queue) {
+    long i;
+    while ((i = fetch_increment(&queue->next)) < queue->end) {
+        run_frame(pool->instances[i].gb);
+        pool->instances[i].frames++;
+    }
+}
+
+static void run_round(Worker *worker) {
+    ThreadPool *pool = worker->pool;
+
+    // Drain our own range, then steal from the others
+    for (int k = 0; k < pool->workers; k++) {
+        run_queue(pool, &pool->queues[(worker->id + k) % pool->workers]);
+    }
+
+    mutex_lock(&pool->lock);
+    if (--pool->pending == 0)
+        cond_broadcast(&pool->done);
+    mutex_unlock(&pool->lock);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI worker_main(LPVOID arg) {
+#else
+static void *worker_main(void *arg) {
+#endif
+    Worker *worker = arg;
+    ThreadPool *pool = worker->pool;
+    unsigned int round = 0;
+
+    while (1) {
+        mutex_lock(&pool->lock);
+        while (!pool->quit && pool->round == round)
+            cond_wait(&pool->start, &pool->lock);
+        if (pool->quit) {
+            mutex_unlock(&pool->lock);
+            break;
+        }
+        round = pool->round;
+        mutex_unlock(&pool->lock);
+
+        run_round(worker);
+    }
+    return 0;
+}
+
+int run_batch(BatchInstance *instances, int count, unsigned int frames, int threads, BatchReport *report) {
+    for (int i = 0; i < count; i++) {
+        if (instances[i].gb != NULL)
+            continue;
+        instances[i].gb = create_gameboy();
+        if (instances[i].gb == NULL || power_on(instances[i].gb, instances[i].filename) == 1)
+            return 1;
+        set_engine(instances[i].gb, instances[i].engine);
+    }
+
+    if (threads <= 0)
+        threads = processor_count();
+    if (threads > count)
+        threads = count > 0 ? count : 1;
+
+    ThreadPool pool = { 0 };
+    pool.instances = instances;
+    pool.workers = threads;
+    pool.queues = calloc(threads, sizeof(WorkQueue));
+    THREAD *handles = calloc(threads, sizeof(THREAD));
+    Worker *workers = calloc(threads, sizeof(Worker));
+    if (pool.queues == NULL || handles == NULL || workers == NULL) {
+        free(pool.queues);
+        free(handles);
+        free(workers);
+        return 1;
+    }
+    mutex_init(&pool.lock);
+    cond_init(&pool.start);
+    cond_init(&pool.done);
+
+    // Run with the workers that could be started. A round waits for every worker counted in
+    // pending, so only workers that are running can be counted
+    int started = 0;
+    for (int i = 0; i < threads; i++) {
+        workers[i].pool = &pool;
+        workers[i].id = i;
+#ifdef _WIN32
+        handles[i] = CreateThread(NULL, 0, worker_main, &workers[i], 0, NULL);
+        if (handles[i] == NULL)
+            break;
+#else
+        if (pthread_create(&handles[i], NULL, worker_main, &workers[i]) != 0)
+            break;
+#endif
+        started++;
+    }
+    if (started == 0)
+        fprintf_s(stderr, "cannot start any worker threads\n");
+    else if (started < threads)
+        fprintf_s(stderr, "started %d of %d worker threads\n", started, threads);
+    // The workers are all waiting for the first round, which is when they read workers
+    threads = started;
+    pool.workers = started;
+
+    double start = seconds_now();
+    for (unsigned int frame = 0; frame < frames && threads > 0; frame++) {
+        mutex_lock(&pool.lock);
+        for (int i = 0; i < threads; i++) {
+            pool.queues[i].next = (long)((long long)count * i / threads);
+            pool.queues[i].end = (long)((long long)count * (i + 1) / threads);
+        }
+        pool.pending = threads;
+        pool.round++;
+        cond_broadcast(&pool.start);
+        while (pool.pending > 0)
+            cond_wait(&pool.done, &pool.lock);
+        mutex_unlock(&pool.lock);
+    }
+    double seconds = seconds_now() - start;
+
+    mutex_lock(&pool.lock);
+    pool.quit = 1;
+    cond_broadcast(&pool.start);
+    mutex_unlock(&pool.lock);
+    for (int i = 0; i < threads; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(handles[i], INFINITE);
+        CloseHandle(handles[i]);
+#else
+        pthread_join(handles[i], NULL);
+#endif
+    }
+    cond_destroy(&pool.done);
+    cond_destroy(&pool.start);
+    mutex_destroy(&pool.lock);
+    free(pool.queues);
+    free(handles);
+    free(workers);
+    if (threads == 0)
+        return 1;
+
+    if (report != NULL) {
+        report->frames = (unsigned long long)frames * count;
+        report->seconds = seconds;
+        report->frames_per_second = seconds > 0 ? report->frames / seconds : 0;
+        report->threads = threads;
+        report->idle_cycles_skipped = 0;
+        report->dma_cycles = 0;
+        for (int i = 0; i < count; i++) {
+            report->idle_cycles_skipped += instances[i].gb->idle_cycles_skipped;
+            report->dma_cycles += instances[i].gb->dma_cycles;
+        }
+    }
+    return 0;
+}
+
+void free_batch(BatchInstance *instances, int count) {
+    for (int i = 0; i < count; i++) {
+        destroy_gameboy(instances[i].gb);
+        instances[i].gb = NULL;
+    }
+}
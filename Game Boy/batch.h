@@ -0,0 +1,32 @@
+#ifndef BATCH_H
+#define BATCH_H
+#include "cpu.h"
+
+/* One headless instance in a batch. Set filename before the first run_batch() call;
+   the instance is created and powered on the first time it is run */
+typedef struct {
+    char *filename;
+    GameBoy *gb;
+    unsigned int frames;    // Frames run so far
+    int engine;             // ENGINE_INTERPRETER, ENGINE_JIT or ENGINE_JIT_CHECK (emulator.h)
+} BatchInstance;
+
+typedef struct {
+    unsigned long long frames;  // Frames run by all instances together
+    double seconds;             // Wall clock time
+    double frames_per_second;
+    int threads;
+    unsigned long long idle_cycles_skipped;    // Cycles all instances together skipped in idle loops
+    unsigned long long dma_cycles;             // Cycles all instances together spent in OAM DMA transfers
+} BatchReport;
+
+/* Step every instance frame by frame for the given number of frames on a pool of worker threads.
+   All instances finish frame n before any starts frame n + 1. threads <= 0 uses one thread per core.
+   Returns 1 if an instance could not be powered on or no worker thread could be started. Runs on as
+   many workers as could be started if that is fewer than asked for */
+int run_batch(BatchInstance *instances, int count, unsigned int frames, int threads, BatchReport *report);
+
+/* Destroy the GameBoy of every instance */
+void free_batch(BatchInstance *instances, int count);
+
+#endif
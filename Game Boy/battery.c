@@ -0,0 +1,295 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gameboy.h"
+#include "battery.h"
+#include "mbc.h"
+#include "memory_map.h"
+#include "rtc.h"
+#include "scheduler.h"
+#include "threads.h"
+
+#ifdef _WIN32
+#include <io.h>
+#define sync_file(fp) _commit(_fileno(fp))
+#else
+#define sync_file(fp) fsync(fileno(fp))
+#endif
+
+/*  Battery backed RAM
+    The RAM of a cartridge with a battery is kept in a .sav next to the ROM, loaded when the
+    cartridge is and written back by one save thread shared by every instance.
+
+    Its pages start out with no write page, so the first write to each one goes through
+    mbc_write_ram(), which marks it dirty and maps it so later writes are plain stores. A second
+    after the first page got dirty EVENT_SAVE copies the dirty pages, and only those, into the
+    file's image, clears them and takes them out of the write pages again. The save thread writes the
+    image to a temporary file and renames it over the .sav, so a crash part way leaves the last
+    complete save in place.
+
+    The MBC3 clock follows the RAM in the file (rtc.c). It is stored again whenever the RAM is and
+    always on battery_close(), so the file has the time the game was closed.
+
+    Instances that run the same cartridge share the one SaveFile, and so the one image and temporary
+    file. The second to open it starts from the image rather than the .sav, which may be behind it.
+    Saves are only opened for instances that asked for them with set_battery_saves(), so batch runs
+    and tools such as --aot do not write over the player's .sav.
+
+    The emulation thread never waits on the disk. It only holds the lock to copy a few pages, and if
+    the save thread is holding it the copy is tried again a frame later. Only the last battery_close()
+    of a file waits, for the save thread to write what is left. The save thread does every write, so
+    a file is never written by two threads at once.
+*/
+
+#define SAVE_DELAY 4194304  // Cycles from the first write to the save, one second
+#define SAVE_RETRY 70224    // Cycles until trying again if the save thread has the lock, one frame
+#define SAVE_MAX (sizeof(((GameBoy *)0)->ram_banks) + RTC_SAVE_SIZE)
+
+typedef struct SaveFile {
+    char *path;
+    char *temp_path;
+    BYTE *image;                // What the .sav is to hold, updated from the dirty pages
+    unsigned int size;
+    int users;                  // Instances that have the file open, it is freed when the last one closes it
+    int pending;                // image has changes the .sav does not
+    int writing;                // The save thread is writing the file, so it cannot be freed
+    struct SaveFile *next;
+} SaveFile;
+
+static MUTEX lock = MUTEX_INIT;
+static CONDITION_VAR wake = CONDITION_INIT;     // A file is pending
+static CONDITION_VAR written = CONDITION_INIT;  // The save thread finished writing a file
+static SaveFile *files;
+static int thread_started;
+
+/* Write size bytes to the temporary file and rename it over the .sav. Returns 1 if either fails */
+static int write_file(SaveFile *file, const BYTE *data, unsigned int size) {
+    FILE *fp;
+    if (fopen_s(&fp, file->temp_path, "wb") != 0)
+        return 1;
+    int failed = fwrite(data, 1, size, fp) != size || fflush(fp) != 0 || sync_file(fp) != 0;
+    if (fclose(fp) != 0 || failed) {
+        remove(file->temp_path);
+        return 1;
+    }
+#ifdef _WIN32
+    return !MoveFileExA(file->temp_path, file->path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+    return rename(file->temp_path, file->path) != 0;
+#endif
+}
+
+#ifdef _WIN32
+static DWORD WINAPI save_main(LPVOID arg) {
+#else
+static void *save_main(void *arg) {
+#endif
+    static BYTE buffer[SAVE_MAX];
+    (void)arg;
+    mutex_lock(&lock);
+    while (1) {
+        SaveFile *file = files;
+        while (file != NULL && !file->pending)
+            file = file->next;
+        if (file == NULL) {
+            cond_wait(&wake, &lock);
+            continue;
+        }
+        // Write a copy so the emulation thread can stage more pages meanwhile
+        unsigned int size = file->size;
+        memcpy(buffer, file->image, size);
+        file->pending = 0;
+        file->writing = 1;
+        mutex_unlock(&lock);
+
+        if (write_file(file, buffer, size) != 0)
+            fprintf_s(stderr, "cannot write save file '%s'\n", file->path);
+
+        mutex_lock(&lock);
+        file->writing = 0;
+        cond_broadcast(&written);
+    }
+    return 0;
+}
+
+/* Copy the dirty pages into the image for the save thread. Called with the lock held */
+static void stage(GameBoy *gb, SaveFile *file) {
+    for (unsigned int page = 0; page < sizeof(gb->ram_dirty); page++) {
+        if (gb->ram_dirty[page] && page * PAGE_SIZE < gb->ram_size)
+            memcpy(file->image + page * PAGE_SIZE, &gb->ram_banks[page * PAGE_SIZE], PAGE_SIZE);
+        gb->ram_dirty[page] = 0;
+    }
+    gb->ram_dirty_pages = 0;
+    if (gb->rtc)
+        rtc_save(gb, file->image + gb->ram_size);
+    file->pending = 1;
+}
+
+/* The ROM's path with its extension replaced by .sav, and the same with .tmp on the end */
+static int save_paths(SaveFile *file, const char *filename) {
+    size_t length = strlen(filename);
+    const char *dot = strrchr(filename, '.');
+    if (dot != NULL && strpbrk(dot, "/\\") == NULL)
+        length = dot - filename;
+    file->path = malloc(length + sizeof(".sav"));
+    file->temp_path = malloc(length + sizeof(".sav.tmp"));
+    if (file->path == NULL || file->temp_path == NULL)
+        return 1;
+    memcpy(file->path, filename, length);
+    memcpy(file->path + length, ".sav", sizeof(".sav"));
+    memcpy(file->temp_path, filename, length);
+    memcpy(file->temp_path + length, ".sav.tmp", sizeof(".sav.tmp"));
+    return 0;
+}
+
+static void free_file(SaveFile *file) {
+    free(file->path);
+    free(file->temp_path);
+    free(file->image);
+    free(file);
+}
+
+/* Start the save thread if it is not running. Called with the lock held */
+static void start_thread(void) {
+    if (thread_started)
+        return;
+#ifdef _WIN32
+    HANDLE thread = CreateThread(NULL, 0, save_main, NULL, 0, NULL);
+    thread_started = thread != NULL;
+    if (thread != NULL)
+        CloseHandle(thread);
+#else
+    THREAD thread;
+    thread_started = pthread_create(&thread, NULL, save_main, NULL) == 0;
+    if (thread_started)
+        pthread_detach(thread);
+#endif
+}
+
+/* Load ram_banks and the clock from the file's image, for an instance opening a file that is in use */
+static void load_image(GameBoy *gb, SaveFile *file) {
+    memcpy(gb->ram_banks, file->image, gb->ram_size);
+    if (gb->rtc)
+        rtc_load(gb, file->image + gb->ram_size, RTC_SAVE_SIZE);
+}
+
+/* Load ram_banks and the clock from the .sav and start the file's image from them */
+static void load_file(GameBoy *gb, SaveFile *file) {
+    FILE *fp;
+    if (fopen_s(&fp, file->path, "rb") == 0) {
+        fread(gb->ram_banks, 1, gb->ram_size, fp);
+        if (gb->rtc) {
+            BYTE footer[RTC_SAVE_SIZE];
+            rtc_load(gb, footer, (unsigned int)fread(footer, 1, sizeof(footer), fp));
+        }
+        fclose(fp);
+    }
+    memcpy(file->image, gb->ram_banks, gb->ram_size);
+    if (gb->rtc)
+        rtc_save(gb, file->image + gb->ram_size);
+}
+
+void battery_open(GameBoy *gb, const char *filename) {
+    memset(gb->ram_dirty, 0, sizeof(gb->ram_dirty));
+    gb->ram_dirty_pages = 0;
+    if (!gb->battery_saves || !gb->battery || (gb->ram_size == 0 && !gb->rtc))
+        return;
+
+    SaveFile *file = calloc(1, sizeof(SaveFile));
+    if (file == NULL)
+        return;
+    if (save_paths(file, filename) != 0) {
+        free_file(file);
+        return;
+    }
+    unsigned int size = gb->ram_size + (gb->rtc ? RTC_SAVE_SIZE : 0);
+
+    mutex_lock(&lock);
+    SaveFile *open = files;
+    while (open != NULL && strcmp(open->path, file->path) != 0)
+        open = open->next;
+    if (open != NULL) {
+        free_file(file);
+        file = NULL;
+        if (open->size == size) {
+            open->users++;
+            load_image(gb, open);
+            file = open;
+        }
+        else
+            fprintf_s(stderr, "save file '%s' is in use by a different cartridge\n", open->path);
+    }
+    else if ((file->image = malloc(size)) != NULL) {
+        file->size = size;
+        file->users = 1;
+        load_file(gb, file);
+        start_thread();
+        file->next = files;
+        files = file;
+    }
+    else {
+        free_file(file);
+        file = NULL;
+    }
+    mutex_unlock(&lock);
+    if (file == NULL)
+        return;
+
+    // Take the RAM out of the write pages so the first write to each page is seen
+    gb->save = file;
+    mbc_map(gb);
+}
+
+void battery_close(GameBoy *gb) {
+    SaveFile *file = gb->save;
+    if (file == NULL)
+        return;
+    gb->save = NULL;
+
+    mutex_lock(&lock);
+    if (gb->ram_dirty_pages != 0 || gb->rtc)
+        stage(gb, file);
+    if (--file->users > 0) {
+        cond_broadcast(&wake);
+        mutex_unlock(&lock);
+        mbc_map(gb);
+        return;
+    }
+
+    // Let the save thread write what is left, then nothing else can see the file
+    if (thread_started) {
+        cond_broadcast(&wake);
+        while (file->pending || file->writing)
+            cond_wait(&written, &lock);
+    }
+    else if (file->pending && write_file(file, file->image, file->size) != 0)
+        fprintf_s(stderr, "cannot write save file '%s'\n", file->path);
+    SaveFile **link = &files;
+    while (*link != file)
+        link = &(*link)->next;
+    *link = file->next;
+    mutex_unlock(&lock);
+
+    free_file(file);
+    mbc_map(gb);
+}
+
+void battery_dirty(GameBoy *gb, unsigned int page) {
+    gb->ram_dirty[page] = 1;
+    if (gb->ram_dirty_pages++ == 0)
+        schedule_event(gb, EVENT_SAVE, gb->total_cycles + SAVE_DELAY);
+}
+
+void battery_sync(GameBoy *gb) {
+    SaveFile *file = gb->save;
+    if (file == NULL || gb->ram_dirty_pages == 0)
+        return;
+    if (!mutex_trylock(&lock)) {
+        schedule_event(gb, EVENT_SAVE, gb->total_cycles + SAVE_RETRY);
+        return;
+    }
+    stage(gb, file);
+    cond_broadcast(&wake);
+    mutex_unlock(&lock);
+    mbc_map(gb);
+}
@@ -0,0 +1,21 @@
+#ifndef BATTERY_H
+#define BATTERY_H
+#include "cpu.h"
+
+/* Load the .sav next to the ROM into ram_banks and the MBC3 clock, and start saving them for a
+   cartridge with a battery. Called by load_rom() after mbc_init(). Does nothing for other cartridges,
+   or unless set_battery_saves() turned saves on */
+void battery_open(GameBoy *gb, const char *filename);
+
+/* Hand the RAM written since the last save, and the clock, to the save thread. The last instance to
+   close a .sav waits for it to be written. Called by destroy_gameboy() and before another cartridge
+   is loaded */
+void battery_close(GameBoy *gb);
+
+/* Mark a page of ram_banks as written. Called by mbc_write_ram() the first time a clean page is written */
+void battery_dirty(GameBoy *gb, unsigned int page);
+
+/* Hand the dirty pages to the save thread. Serviced for EVENT_SAVE */
+void battery_sync(GameBoy *gb);
+
+#endif
@@ -0,0 +1,113 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gameboy.h"
+#include "emulator.h"
+#include "benchmark.h"
+
+/* The loop runs from 0x0150 with interrupts off, the same way as code loaded from a cartridge */
+static const BYTE alu_loop[] = {
+    0x06, 0x00,         // 0150 LD B,0x00
+    0x81,               // 0152 ADD A,C
+    0x8A,               // 0153 ADC A,D
+    0x93,               // 0154 SUB E
+    0x9C,               // 0155 SBC A,H
+    0x0C,               // 0156 INC C
+    0x15,               // 0157 DEC D
+    0xAD,               // 0158 XOR L
+    0xC6, 0x27,         // 0159 ADD A,0x27
+    0x27,               // 015B DAA
+    0xE6, 0xF7,         // 015C AND 0xF7
+    0xB8,               // 015E CP B
+    0x1C,               // 015F INC E
+    0x05,               // 0160 DEC B
+    0x20, 0xEF,         // 0161 JR NZ,0x0152
+    0xC3, 0x50, 0x01,   // 0163 JP 0x0150
+};
+
+/* Cycles and instructions of one pass through the outer loop: LD B, 256 passes through the inner loop and JP */
+#define ALU_LOOP_CYCLES (8 + 256 * 68 + 12)
+#define ALU_LOOP_INSTRUCTIONS (2 + 256 * 14)
+
+static const BYTE register_loop[] = {
+    0x06, 0x00,         // 0150 LD B,0x00
+    0x81,               // 0152 ADD A,C
+    0x8A,               // 0153 ADC A,D
+    0x93,               // 0154 SUB E
+    0x9C,               // 0155 SBC A,H
+    0xA5,               // 0156 AND L
+    0xA9,               // 0157 XOR C
+    0xB2,               // 0158 OR D
+    0xBB,               // 0159 CP E
+    0x0C,               // 015A INC C
+    0x15,               // 015B DEC D
+    0x67,               // 015C LD H,A
+    0x69,               // 015D LD L,C
+    0x1C,               // 015E INC E
+    0x05,               // 015F DEC B
+    0x20, 0xF0,         // 0160 JR NZ,0x0152
+    0xC3, 0x50, 0x01,   // 0162 JP 0x0150
+};
+
+#define REGISTER_LOOP_CYCLES (8 + 256 * 64 + 12)
+#define REGISTER_LOOP_INSTRUCTIONS (2 + 256 * 15)
+
+static const char *engine_name(void) {
+    switch (FLAG_MODE) {
+    case FLAGS_EAGER: return "eager";
+    case FLAGS_LAZY: return "lazy";
+    case FLAGS_TABLE: return "table";
+    default: return "unknown";
+    }
+}
+
+static const char *dispatch_name(void) {
+#if THREADED
+    return "threaded";
+#elif BLOCK_CACHE
+    return "block cache";
+#elif DISPATCH_TABLE
+    return "table";
+#else
+    return "switch";
+#endif
+}
+
+/* Run the loop from 0x0150 for the given number of frames */
+static void run_loop(const BYTE *loop, unsigned int size, unsigned int loop_cycles, unsigned int loop_instructions,
+    unsigned int frames, BenchmarkReport *report) {
+    GameBoy *gb = create_gameboy();
+    if (gb == NULL)
+        return;
+    cpu_init(gb);
+    scheduler_init(gb);
+    memcpy(&gb->rom[0x150], loop, size);
+    gb->PC = 0x150;
+    gb->rom[0xFFFF] = 0x00;
+    // Keep the background and sprites off, drawing them takes longer than the loop being timed
+    gb->rom[0xFF40] &= ~0x03;
+
+    clock_t start = clock();
+    unsigned long long cycles = 0;
+    for (unsigned int i = 0; i < frames; i++) {
+        cycles += run_cycles(gb, CYCLES_PER_FRAME);
+    }
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    report->engine = engine_name();
+    report->dispatch = dispatch_name();
+    report->cycles = cycles;
+    report->instructions = cycles * loop_instructions / loop_cycles;
+    report->seconds = seconds;
+    report->mhz = seconds > 0 ? cycles / seconds / 1e6 : 0;
+    report->mips = seconds > 0 ? report->instructions / seconds / 1e6 : 0;
+    destroy_gameboy(gb);
+}
+
+void alu_benchmark(unsigned int frames, BenchmarkReport *report) {
+    run_loop(alu_loop, sizeof(alu_loop), ALU_LOOP_CYCLES, ALU_LOOP_INSTRUCTIONS, frames, report);
+}
+
+void register_benchmark(unsigned int frames, BenchmarkReport *report) {
+    run_loop(register_loop, sizeof(register_loop), REGISTER_LOOP_CYCLES, REGISTER_LOOP_INSTRUCTIONS, frames, report);
+}
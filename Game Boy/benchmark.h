@@ -0,0 +1,23 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+#include "cpu.h"
+
+typedef struct {
+    const char *engine;     // Name of the flags engine the build was compiled with
+    const char *dispatch;   // Name of the dispatch engine the build was compiled with
+    unsigned long long cycles;
+    unsigned long long instructions;    // Worked out from the cycles and the fixed instruction mix of the loop
+    double seconds;         // CPU time
+    double mhz;             // Emulated cycles per second, in millions. Real hardware runs at 4.19 MHz
+    double mips;            // Emulated instructions per second, in millions
+} BenchmarkReport;
+
+/* Run a loop of 8-bit arithmetic (ADD, ADC, SUB, SBC, AND, XOR, CP, INC, DEC, DAA and JR NZ) for the
+   given number of frames using the flags engine selected by FLAG_MODE. Build once per FLAG_MODE to compare them */
+void alu_benchmark(unsigned int frames, BenchmarkReport *report);
+
+/* Run a loop of register to register instructions (LD r,r' and ADD, ADC, SUB, SBC, AND, XOR, OR, CP, INC
+   and DEC on B-L) for the given number of frames. Build once per dispatch engine to compare them */
+void register_benchmark(unsigned int frames, BenchmarkReport *report);
+
+#endif
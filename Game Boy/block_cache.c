@@ -0,0 +1,188 @@
+#include <stdlib.h>
+#include <string.h>
+#include "gameboy.h"
+#include "block_cache.h"
+#include "emulator.h"
+#include "jit.h"
+#include "fusion.h"
+#include "memory_map.h"
+#include "mbc.h"
+
+/*  Block cache
+    Blocks are decoded by running them once through execute() and recording the handler and the number of
+    cycles of each instruction. After that the block runs straight from the array, with no fetch, no decode
+    and no second dispatch for CB prefixed instructions. Every instruction but the last one returns the same
+    number of cycles each time, so a body that fits before stop_cycle can run as native code (jit.c). The
+    interpreter checks stop_cycle after every instruction, since one that writes an I/O register or enables
+    interrupts can schedule an event and lower it part way through the block.
+
+    Blocks are keyed by PC and the memory mapped at PC, so a block decoded from one ROM bank does not run
+    when another bank is selected, and blocks never run on into the next 16 KB. A bank switch lowers
+    stop_cycle (mbc.c), so a block that switches its own bank stops at the write. Only ROM, work RAM, High RAM
+    and external RAM are cached, external RAM only when the cartridge cannot switch it. Code in RAM can be
+    overwritten, so every byte a RAM block was decoded from is marked in code_map, and the write pages it is
+    on, and their echo for work RAM, are switched to the handler in write_memory(), which drops the blocks when
+    a marked byte is written.
+*/
+
+static int cacheable(GameBoy *gb, WORD address) {
+    if (address >= 0xA000 && address < 0xC000)
+        return gb->mbc == MBC_NONE;
+    return address < 0x8000 || (address >= 0xC000 && address < 0xE000) || (address >= 0xFF80 && address < 0xFFFF);
+}
+
+static int ends_block(BYTE opcode) {
+    switch (opcode) {
+    case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:     // JR
+    case 0xC2: case 0xC3: case 0xCA: case 0xD2: case 0xDA:     // JP
+    case 0xE9:                                                  // JP (HL)
+    case 0xC4: case 0xCC: case 0xCD: case 0xD4: case 0xDC:     // CALL
+    case 0xC0: case 0xC8: case 0xC9: case 0xD0: case 0xD8:     // RET
+    case 0xD9:                                                  // RETI
+    case 0xC7: case 0xCF: case 0xD7: case 0xDF:                // RST
+    case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+    case 0x76:                                                  // HALT
+    case 0x10:                                                  // STOP
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+int block_cache_init(GameBoy *gb) {
+    gb->blocks = calloc(BLOCK_CACHE_SIZE, sizeof(Block));
+    return gb->blocks == NULL;
+}
+
+void block_cache_free(GameBoy *gb) {
+    free(gb->blocks);
+    gb->blocks = NULL;
+}
+
+void block_cache_reset(GameBoy *gb) {
+    if (gb->blocks != NULL) {
+        for (int i = 0; i < BLOCK_CACHE_SIZE; i++)
+            gb->blocks[i].valid = 0;
+    }
+    memset(gb->code_map, 0, sizeof(gb->code_map));
+#if JIT
+    jit_reset(gb);
+#endif
+}
+
+void block_cache_invalidate(GameBoy *gb, WORD address) {
+    for (int i = 0; i < BLOCK_CACHE_SIZE; i++) {
+        Block *block = &gb->blocks[i];
+        if (block->valid && address >= block->start && address < block->end)
+            block->valid = 0;
+    }
+    gb->block_generation++;
+}
+
+/* Mark the bytes from start up to end as code, so writes to them reach block_cache_invalidate() */
+static void mark_code(GameBoy *gb, WORD start, unsigned int end) {
+    if (start < 0x8000)
+        return;
+    for (unsigned int address = start; address < end && address <= 0xFFFF; address++) {
+        gb->code_map[address >> 3] |= 1 << (address & 0x07);
+        gb->write_page[address >> 8] = NULL;
+        // Work RAM can also be written through its echo
+        if (address >= 0xC000 && address < 0xDE00)
+            gb->write_page[(address + 0x2000) >> 8] = NULL;
+    }
+}
+
+/* Run instructions one at a time from PC with execute(), recording them into the block */
+static WORD decode_block(GameBoy *gb, Block *block) {
+    WORD pc = gb->PC;
+    unsigned int generation = gb->block_generation;
+    block->start = pc;
+    block->memory = gb->memory_page[pc >> 8];
+    block->valid = 0;
+    block->hits = 0;
+    block->native = NULL;
+    block->count = 0;
+    block->body_cycles = 0;
+
+    while (1) {
+        pc = gb->PC;
+        BYTE opcode = MEMORY_AT(gb, pc);
+        // Marked before it runs, so an instruction further on that overwrites it is noticed
+        mark_code(gb, pc, pc + 3);
+        int cycles = execute(gb);
+        gb->total_cycles += cycles;
+
+        MicroOp *op = &block->ops[block->count++];
+        if (opcode == 0xCB) {
+            op->opcode = MEMORY_AT(gb, pc + 1);
+            op->handler = cb_table[op->opcode];
+            op->operands = pc + 2;
+        }
+        else {
+            op->opcode = opcode;
+            op->handler = main_table[opcode];
+            op->operands = pc + 1;
+        }
+        op->pc = pc;
+        op->cycles = cycles;
+
+        if (ends_block(opcode) || block->count == BLOCK_MAX_OPS || gb->total_cycles >= gb->stop_cycle
+            || gb->PC <= pc || !cacheable(gb, gb->PC) || ((gb->PC ^ pc) & 0xC000))
+            break;
+        block->body_cycles += cycles;
+    }
+
+    // The last instruction is at most 3 bytes long. A block that overwrote its own code is not kept
+    block->end = pc + 3 < 0x10000 ? pc + 3 : 0xFFFF;
+    block->valid = gb->block_generation == generation;
+#if FUSION
+    fusion_detect(gb, block);
+#endif
+    return pc;
+}
+
+WORD execute_block(GameBoy *gb) {
+    WORD pc = gb->PC;
+    if (!cacheable(gb, pc)) {
+        gb->total_cycles += execute(gb);
+        return pc;
+    }
+
+    // The same address in different banks goes to different slots, so code that switches banks
+    // does not keep decoding its blocks over each other
+    const BYTE *memory = gb->memory_page[pc >> 8];
+    Block *block = &gb->blocks[(pc ^ (unsigned int)((size_t)memory >> 14 << 7)) & (BLOCK_CACHE_SIZE - 1)];
+    if (!block->valid || block->start != pc || block->memory != memory)
+        return decode_block(gb, block);
+#if FUSION
+    if (block->fusion != FUSION_NONE)
+        fusion_run(gb, block);
+#endif
+
+    unsigned int generation = gb->block_generation;
+    int i = 0;
+#if JIT
+    // A hot ROM block that fits before stop_cycle can run as native code. It returns early if an
+    // instruction lowers stop_cycle into the block, and the rest is interpreted
+    if (gb->total_cycles + block->body_cycles < gb->stop_cycle && gb->engine != ENGINE_INTERPRETER) {
+        i = jit_run_block(gb, block);
+        if (i > 0) {
+            pc = block->ops[i - 1].pc;
+            if (i == block->count || gb->total_cycles >= gb->stop_cycle)
+                return pc;
+        }
+    }
+#endif
+    for (; i < block->count; i++) {
+        MicroOp *op = &block->ops[i];
+        gb->opcode = op->opcode;
+        gb->PC = op->operands;
+        gb->total_cycles += op->handler(gb);
+        pc = op->pc;
+
+        // Stop if stop_cycle is reached, or if the block has just overwritten itself
+        if (gb->total_cycles >= gb->stop_cycle || gb->block_generation != generation)
+            break;
+    }
+    return pc;
+}
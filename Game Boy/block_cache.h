@@ -0,0 +1,52 @@
+#ifndef BLOCK_CACHE_H
+#define BLOCK_CACHE_H
+#include "cpu.h"
+#include "opcodes.h"
+
+#define BLOCK_MAX_OPS 16
+#define BLOCK_CACHE_SIZE 2048   // Must be a power of 2
+
+/* One decoded instruction */
+typedef struct {
+    OPCODE_HANDLER handler; // Handler from main_table, or from cb_table for CB prefixed instructions
+    WORD pc;                // Address of the instruction
+    WORD operands;          // Address of the first operand, where the handler expects PC to be
+    BYTE opcode;
+    BYTE cycles;
+} MicroOp;
+
+/* A run of straight-line instructions that ends at the first jump, call, return, RST, HALT or STOP */
+struct Block {
+    WORD start;
+    WORD end;               // One past the last byte the block could have been decoded from
+    const BYTE *memory;     // memory_page of the start when it was decoded, which tells ROM banks apart
+    BYTE valid;
+    BYTE count;
+    unsigned short body_cycles; // Cycles of every instruction but the last, which is the only one that can branch
+    BYTE fusion;                // FUSION_NONE or the loop the block is (fusion.c)
+    BYTE fusion_reg;            // Register the loop counts down, in opcode encoding order
+    unsigned short hits;        // Times the block has been interpreted, until it is compiled
+    int (*native)(GameBoy *gb);     // Compiled block (jit.c), or NULL. Returns the instructions it ran
+    MicroOp ops[BLOCK_MAX_OPS];
+};
+typedef struct Block Block;
+
+/* Non-zero if a cached block was decoded from the byte at address */
+#define CODE_MARKED(gb, address) ((gb)->code_map[(address) >> 3] & (1 << ((address) & 0x07)))
+
+/* Allocate the cache. Returns 1 if out of memory */
+int block_cache_init(GameBoy *gb);
+
+void block_cache_free(GameBoy *gb);
+
+/* Drop every block. Called when a new cartridge is loaded */
+void block_cache_reset(GameBoy *gb);
+
+/* Drop every block decoded from the byte at address. Called by write_memory() for bytes marked in code_map */
+void block_cache_invalidate(GameBoy *gb, WORD address);
+
+/* Run the block at PC, decoding it first if it is not cached, stopping early once total_cycles reaches
+   stop_cycle, which an instruction in the block can lower. Returns the address of the last instruction run */
+WORD execute_block(GameBoy *gb);
+
+#endif
@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gameboy.h"
+#include "cartridge.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+/*  Cartridge images
+    A cartridge that is a power of 2 banks of at least 32 KB, which every real one is, is mapped
+    read-only straight from the file and the ROM pages point into the mapping. Nothing is read at
+    load time, the operating system pages the ROM in as it is touched, and every instance running
+    the same cartridge shares the one copy in the page cache instead of holding up to 8 MB each.
+
+    Anything else, such as a short test ROM, is read into a buffer and padded with 0xFF to a power
+    of 2 banks, so the bank numbers mbc.c selects can always be masked into the image.
+*/
+
+#define CARTRIDGE_MIN 0x8000
+#define CARTRIDGE_MAX 0x800000     // 512 banks, the most MBC5 can select
+
+/* Map the first size bytes of the file read-only. Returns NULL if it cannot be mapped */
+static BYTE *map_file(const char *filename, unsigned int size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL)
+        return NULL;
+    // The view keeps the mapping open
+    BYTE *memory = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    CloseHandle(mapping);
+    return memory;
+#else
+    int file = open(filename, O_RDONLY);
+    if (file < 0)
+        return NULL;
+    void *memory = mmap(NULL, size, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    return memory == MAP_FAILED ? NULL : memory;
+#endif
+}
+
+static void unmap_file(BYTE *memory, unsigned int size) {
+#ifdef _WIN32
+    UnmapViewOfFile(memory);
+#else
+    munmap(memory, size);
+#endif
+}
+
+/* Read the file into a buffer padded to padded bytes */
+static BYTE *read_file(FILE *fp, long size, unsigned int padded) {
+    BYTE *memory = malloc(padded);
+    if (memory == NULL)
+        return NULL;
+    size_t loaded = fread(memory, 1, size, fp);
+    memset(memory + loaded, 0xFF, padded - loaded);
+    return memory;
+}
+
+int cartridge_load(GameBoy *gb, const char *filename) {
+    FILE *fp;
+    if (fopen_s(&fp, filename, "rb") != 0)
+        return 1;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (size < 0)
+        size = 0;
+    if (size > CARTRIDGE_MAX) {
+        fprintf_s(stderr, "'%s' is larger than any cartridge can be\n", filename);
+        fclose(fp);
+        return 1;
+    }
+    unsigned int padded = CARTRIDGE_MIN;
+    while (padded < (unsigned long)size)
+        padded <<= 1;
+
+    cartridge_unload(gb);
+    if ((unsigned long)size == padded && (gb->cartridge_memory = map_file(filename, padded)) != NULL)
+        gb->cartridge_mapped = 1;
+    else
+        gb->cartridge_memory = read_file(fp, size, padded);
+    fclose(fp);
+
+    if (gb->cartridge_memory == NULL)
+        return 1;
+    gb->cartridge_size = padded;
+    return 0;
+}
+
+void cartridge_unload(GameBoy *gb) {
+    if (gb->cartridge_mapped)
+        unmap_file(gb->cartridge_memory, gb->cartridge_size);
+    else
+        free(gb->cartridge_memory);
+    gb->cartridge_memory = NULL;
+    gb->cartridge_mapped = 0;
+    gb->cartridge_size = 0;
+}
@@ -0,0 +1,12 @@
+#ifndef CARTRIDGE_H
+#define CARTRIDGE_H
+#include "cpu.h"
+
+/* Load the cartridge image into cartridge_memory, replacing any loaded before.
+   Returns 1 if the file could not be opened or read, is larger than 8 MB, or if out of memory */
+int cartridge_load(GameBoy *gb, const char *filename);
+
+/* Release the loaded image. Called by destroy_gameboy() */
+void cartridge_unload(GameBoy *gb);
+
+#endif
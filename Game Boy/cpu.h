@@ -7,20 +7,64 @@
 #define FLAG_H 5 // Half carry flag
 #define FLAG_C 4 // Carry flag
 
+/* Opcode dispatch engine. 1 = handler tables in opcodes.c, 0 = the switch statements in cpu.c */
+#ifndef DISPATCH_TABLE
+#define DISPATCH_TABLE 1
+#endif
+
+/* 1 = run instructions with the threaded interpreter in threaded.c, which keeps the registers in locals,
+   instead of the block cache */
+#ifndef THREADED
+#define THREADED 0
+#endif
+
+/* How the ALU helpers produce the flags. FLAGS_EAGER builds F after every instruction,
+   FLAGS_LAZY records the last operation and only builds F when something reads it (flags.c),
+   FLAGS_TABLE looks up the result and F in precomputed tables (alu_tables.c) */
+#define FLAGS_EAGER 0
+#define FLAGS_LAZY 1
+#define FLAGS_TABLE 2
+#ifndef FLAG_MODE
+#define FLAG_MODE FLAGS_TABLE
+#endif
+
+/* 1 = run code from a cache of decoded blocks (block_cache.c). Needs DISPATCH_TABLE, and is not used with THREADED */
+#ifndef BLOCK_CACHE
+#define BLOCK_CACHE (DISPATCH_TABLE && !THREADED)
+#endif
+
+/* 1 = run copy, clear and countdown loops many passes at a time (fusion.c). Needs BLOCK_CACHE */
+#ifndef FUSION
+#define FUSION BLOCK_CACHE
+#endif
+
+/* 1 = compile hot ROM blocks to x86-64 code when the JIT engine is selected (jit.c). Needs BLOCK_CACHE */
+#ifndef JIT
+#if BLOCK_CACHE && (defined(_M_X64) || defined(__x86_64__))
+#define JIT 1
+#else
+#define JIT 0
+#endif
+#endif
+
+/* 1 = run blocks from a ROM translated to C with --aot when that ROM is loaded (aot.c).
+   The generated file has to be added to the build */
+#ifndef AOT
+#define AOT 0
+#endif
+
+/* 1 = skip ahead through loops that poll I/O or High RAM until the next event (idle_loop.c) */
+#ifndef IDLE_LOOP_SKIP
+#define IDLE_LOOP_SKIP 1
+#endif
+
 typedef unsigned char BYTE;
 typedef char SIGNED_BYTE;
 typedef unsigned short WORD;
 typedef signed short SIGNED_WORD;
 
-extern BYTE cartridge_memory[0x200000]; // The Game Boy cartridge holds up to 2 MB
-extern BYTE rom[0x10000];
-extern BYTE ram_banks[0x8000];
-extern BYTE opcode;
-extern WORD PC;
-
-/*Interrupt Master Enable Flag */
-extern BYTE IME;
-
+/* All of the state for one Game Boy. Defined in gameboy.h */
+typedef struct GameBoy GameBoy;
 
 /* There are 8 8-Bit registers from A to L, but can be paired to form 4 16-Bit registers.
 The pairings are AF, BC, DE, HL. A is the accumulator and F is the flag register. */
@@ -32,14 +76,6 @@ union Register {
     };
 }typedef Register;
 
-extern Register RegAF;
-extern Register RegBC;
-extern Register RegDE;
-extern Register RegHL;
-extern Register RegSP;
-extern BYTE *Regs[8];
-
-
 
 typedef enum {
     NONE, NZ, Z, NC, C, HL
@@ -50,16 +86,17 @@ typedef enum {
 }REG;
 
 
-void cpu_init(void);
-void load_rom(char *filename);
-int execute(void);
-int CB(void);
+void cpu_init(GameBoy *gb);
+int load_rom(GameBoy *gb, char *filename);
+int execute(GameBoy *gb);
+int CB(GameBoy *gb);
 
-void cpu_loadReg(BYTE *reg1, BYTE *reg2);
-void write_memory(WORD address, BYTE data);
-BYTE read_memory(WORD address);
-void set_halt();
-void reset_halt();
+void write_memory(GameBoy *gb, WORD address, BYTE data);
+BYTE read_memory(GameBoy *gb, WORD address);
+/* Read the immediate word at PC, low byte first, and move PC past it */
+WORD read_nn(GameBoy *gb);
+void set_halt(GameBoy *gb);
+void reset_halt(GameBoy *gb);
 
 #endif // !1
 
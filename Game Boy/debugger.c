@@ -1,21 +1,23 @@
-#include "cpu.h"
+#include <stdio.h>
+#include "gameboy.h"
 #include "debugger.h"
+#include "opcodes.h"
 
 
 BYTE vram[128][96];   // 16 x 12 Tiles
 BYTE first_byte = 0x00;
 BYTE second_byte = 0x00;
 
-void display_vram() {
+void display_vram(GameBoy *gb) {
     // Each tile is 8x8 pixels
     for (int row = 0; row < 96; row += 8) {
         for (int col = 0; col < 128; col += 8) {
-            add_tile(row, col);
+            add_tile(gb, row, col);
         }
     }
 }
 
-void add_tile(int row, int col) {
+void add_tile(GameBoy *gb, int row, int col) {
     // There are 16 tiles in each row. Every 8 rows and columns is a tile
     int tileNumber = ((row / 8) * 16) + (col / 8);
     // Thereare 16 bytes for each tile
@@ -23,8 +25,8 @@ void add_tile(int row, int col) {
     
     // 8 rows in a tile
     for (int y = 0; y < y; y++) {
-        BYTE byte1 = rom[address + (y * 2)];    // lower bits
-        BYTE byte2 = rom[address + (y * 2) + 1]; // upper bits
+        BYTE byte1 = gb->rom[address + (y * 2)];    // lower bits
+        BYTE byte2 = gb->rom[address + (y * 2) + 1]; // upper bits
 
         // Every two bytes is a row of 8 pixels
         for (int x = 0; x < 8; x++) {
@@ -42,3 +44,33 @@ void add_tile(int row, int col) {
     }
 }
 
+static BYTE peek(GameBoy *gb, WORD address) {
+    BYTE *page = gb->read_page[address >> 8];
+    return page != NULL ? page[address & 0xFF] : gb->rom[address];
+}
+
+int disassemble(GameBoy *gb, WORD address, char *text, int size) {
+    BYTE opcode = peek(gb, address);
+    BYTE n = peek(gb, address + 1);
+    WORD nn = n | (peek(gb, address + 2) << 8);
+    const char *name = opcode_names[opcode];
+
+    switch (opcode_operands[opcode]) {
+    case OPERAND_N:
+        snprintf(text, size, name, n);
+        break;
+    case OPERAND_NN:
+        snprintf(text, size, name, nn);
+        break;
+    case OPERAND_E:
+        snprintf(text, size, name, (WORD)(address + 2 + (SIGNED_BYTE)n));
+        break;
+    case OPERAND_CB:
+        snprintf(text, size, "%s", cb_opcode_names[n]);
+        break;
+    default:
+        snprintf(text, size, "%s", name);
+        break;
+    }
+    return opcode_lengths[opcode];
+}
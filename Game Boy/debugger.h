@@ -1,6 +1,11 @@
 #ifndef DEBUGGER_H
 #define DEBUGGER_H
-void display_vram();
-void add_tile(int row, int col);
+#include "cpu.h"
+void display_vram(GameBoy *gb);
+void add_tile(GameBoy *gb, int row, int col);
+
+/* Write the instruction at address as text, without the side effects of reading I/O registers.
+   Returns the length of the instruction */
+int disassemble(GameBoy *gb, WORD address, char *text, int size);
 
 #endif
\ No newline at end of file
@@ -1,8 +1,10 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <stdio.h>
+#include "gameboy.h"
 #include "display.h"
 #include "interrupts.h"
+#include "memory_map.h"
 
 #define WIDTH 160
 #define HEIGHT 144
@@ -16,12 +18,9 @@
 #define WHITE 0xFFFFFFFF
 
 
-BYTE *lcd_ctrl = &rom[0xFF40];
-unsigned int screen[23040]; // WIDTH * HEIGHT
+GameBoy *display_gb = NULL; // The instance the window shows and sends input to
 GLFWwindow * window = NULL;
 unsigned int texture;
-int prev_mode = 0;
-int mode_clock = 0;
 char vertex_shader[1024 * 256];
 char fragment_shader[1024 * 256];
 int display_width = WIDTH * 5;
@@ -47,88 +46,106 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
         3: During Transferring Data to LCD Driver
  */
 
-void draw(int cycles) {
-   if (test_bit(7, lcd_ctrl) == 0) {
-        rom[LY] = 0;
-        rom[STATUS] &= 252;
-        rom[STATUS] &= ~1;
+void draw(GameBoy *gb, int cycles) {
+   if (test_bit(7, &gb->rom[LCD_Control]) == 0) {
+        gb->rom[LY] = 0;
+        gb->rom[STATUS] &= 252;
+        gb->rom[STATUS] &= ~1;
         return;
    }
 
-    mode_clock += cycles;
-    switch (get_stat_mode()) {
+    gb->mode_clock += cycles;
+    switch (get_stat_mode(gb)) {
 
         // Scanning OAM
     case 2:
-        if (mode_clock >= 80) {
-            mode_clock = 0;
-            set_stat_mode(3);
+        if (gb->mode_clock >= 80) {
+            gb->mode_clock = 0;
+            set_stat_mode(gb, 3);
         }
         break;
 
         // Reading OAM and VRAM
     case 3:
-        if (mode_clock >= 172) {
-            mode_clock = 0;
-            set_stat_mode(0);
-            draw_scanline();
+        if (gb->mode_clock >= 172) {
+            gb->mode_clock = 0;
+            set_stat_mode(gb, 0);
+            draw_scanline(gb);
         }
         break;
 
         // Horizontal blanking
     case 0:
-        if (mode_clock >= 204) {
-            mode_clock = 0;
-            rom[LY] += 1;
+        if (gb->mode_clock >= 204) {
+            gb->mode_clock = 0;
+            gb->rom[LY] += 1;
             
-            if (rom[LY] == 143) {
-                set_stat_mode(1);
-                render_display();
-                int x = 0;
+            if (gb->rom[LY] == 143) {
+                set_stat_mode(gb, 1);
+                gb->frame_ready = 1;
             }
             else {
-                set_stat_mode(2);
+                set_stat_mode(gb, 2);
             }
         }
         break;
 
         // Vertical blanking
     case 1:
-        if (mode_clock >= 456) {
+        if (gb->mode_clock >= 456) {
             // Request V-Blank Interrupt
-            if (rom[LY] == 144) {
-                request_interrupt(0);
+            if (gb->rom[LY] == 144) {
+                request_interrupt(gb, 0);
             }
-            mode_clock = 0;
-            rom[LY] += 1;
+            gb->mode_clock = 0;
+            gb->rom[LY] += 1;
             
-            if (rom[LY] > 153) {
-                set_stat_mode(2);
-                rom[LY] = 0;
+            if (gb->rom[LY] > 153) {
+                set_stat_mode(gb, 2);
+                gb->rom[LY] = 0;
             }
         }
         break;
     }
 
     // Change mode flag in LCD Status Register
-    if (prev_mode != get_stat_mode()) {
-        prev_mode = get_stat_mode();
+    if (gb->prev_mode != get_stat_mode(gb)) {
+        gb->prev_mode = get_stat_mode(gb);
 
         // If interrupt is enabled for mode 0,1,or 2, then request lcd interrupt
-        if (get_stat_mode() != 3) {
-            BYTE b = test_bit(get_stat_mode() + 3, &rom[STATUS]);
+        if (get_stat_mode(gb) != 3) {
+            BYTE b = test_bit(get_stat_mode(gb) + 3, &gb->rom[STATUS]);
             if (b)
-                request_interrupt(LCD);
+                request_interrupt(gb, LCD);
         }
     }
 
-    if (rom[LY] == rom[LYC]) {
-        rom[STATUS] |= 0x04;
-        if(test_bit(6, &rom[STATUS]))
-            request_interrupt(LCD);
+    if (gb->rom[LY] == gb->rom[LYC]) {
+        gb->rom[STATUS] |= 0x04;
+        if(test_bit(6, &gb->rom[STATUS]))
+            request_interrupt(gb, LCD);
     }
     else {
-        rom[STATUS] &= ~0x04;
+        gb->rom[STATUS] &= ~0x04;
+    }
+}
+
+/* Returns the number of cycles until draw() moves the PPU to its next mode */
+int cycles_until_mode_change(GameBoy *gb) {
+    // Poll once per scanline while the LCD is off
+    if (test_bit(7, &gb->rom[LCD_Control]) == 0) {
+        return 456;
+    }
+
+    switch (get_stat_mode(gb)) {
+    case 2:
+        return 80 - gb->mode_clock;
+    case 3:
+        return 172 - gb->mode_clock;
+    case 0:
+        return 204 - gb->mode_clock;
+    default:
+        return 456 - gb->mode_clock;
     }
 }
 
@@ -143,38 +160,38 @@ void draw(int cycles) {
     Bit 0 - BG Display  (0 = Off, 1 = On)
 */
 
-void draw_scanline() {
-  if (test_bit(0, lcd_ctrl) == 1) {
-       draw_tile();
+void draw_scanline(GameBoy *gb) {
+  if (test_bit(0, &gb->rom[LCD_Control]) == 1) {
+       draw_tile(gb);
   }
-  if (test_bit(1, lcd_ctrl) == 1) {
-      draw_sprites();
+  if (test_bit(1, &gb->rom[LCD_Control]) == 1) {
+      draw_sprites(gb);
   }
 }
 
-void draw_tile() {
+void draw_tile(GameBoy *gb) {
     /*  Specifies the position in the 256x256 pixels BG map where the upper left corner of the LCD is to be displayed */
-    int scrollY = read_memory(0xFF42);
-    int scrollX = read_memory(0xFF43);
+    int scrollY = read_memory(gb, 0xFF42);
+    int scrollX = read_memory(gb, 0xFF43);
     
     int bg_map_addr, tile_data_addr;
 
     
-    if (test_bit(3, lcd_ctrl)) {
+    if (test_bit(3, &gb->rom[LCD_Control])) {
         bg_map_addr = 0x9C00;
     }
     else {
         bg_map_addr = 0x9800;
     }
 
-    if (test_bit(4, lcd_ctrl)) {
+    if (test_bit(4, &gb->rom[LCD_Control])) {
         tile_data_addr = 0x8000;
     }
     else {
         tile_data_addr = 0x8800;
     }
 
-    int scanline = read_memory(0xFF44);
+    int scanline = read_memory(gb, 0xFF44);
     int yPos = scrollY + scanline;
 
     /* The screen can wrap around bg map, so % 256 is used to set the position at the top if its greater than 256. 
@@ -189,29 +206,29 @@ void draw_tile() {
         int horizontal_tile = (xPos % 256) / 8;
         
         /* Retrieve index of tile to render */
-        int tile_num = read_memory(bg_map_addr + vertical_tile + horizontal_tile);
+        int tile_num = read_memory(gb, bg_map_addr + vertical_tile + horizontal_tile);
         
         /* The tile data is 8x8 pixels. Eight rows that contain two bytes of data */
         int tile_data_row = (yPos % 8) * 2;
         
         /* Retrieve the tile data lower byte */
-        BYTE tile_data_lb = read_memory((tile_num * 16) + tile_data_row + tile_data_addr);
+        BYTE tile_data_lb = read_memory(gb, (tile_num * 16) + tile_data_row + tile_data_addr);
         /* Retrieve the tile data upper byte */
-        BYTE tile_data_ub = read_memory((tile_num * 16) + tile_data_row + tile_data_addr + 1);
+        BYTE tile_data_ub = read_memory(gb, (tile_num * 16) + tile_data_row + tile_data_addr + 1);
 
         // Draw 8 pixels for the row of tile data
         for (int i = 7; i >= 0; i--) {
             int color_number = (test_bit(i, &tile_data_ub) << 1) | test_bit(i, &tile_data_lb);
-            screen[(scanline * WIDTH) + (x * 8) + (7 - i)] = get_color(color_number);
+            gb->screen[(scanline * WIDTH) + (x * 8) + (7 - i)] = get_color(gb, color_number);
         }
     }
 }
 
-void draw_sprites() {
-    int scanline = read_memory(0xFF44);
+void draw_sprites(GameBoy *gb) {
+    int scanline = read_memory(gb, 0xFF44);
     int sprite_size;
 
-    if (test_bit(2, lcd_ctrl) == 1) {
+    if (test_bit(2, &gb->rom[LCD_Control]) == 1) {
         sprite_size = 16;
     }
     else {
@@ -220,10 +237,10 @@ void draw_sprites() {
 
     for (int i = 0; i < 40; i++) {
         /* There can be 40 sprites in the scene, and each sprite attribute is 4 bytes long */
-        BYTE yPos = read_memory(0xFE00 + ((i * 4) + 0));
-        BYTE xPos = read_memory(0xFE00 + ((i * 4) + 1));
-        BYTE tile_num = read_memory(0xFE00 + ((i * 4) + 2));
-        BYTE flags = read_memory(0xFE00 + ((i * 4) + 3));
+        BYTE yPos = read_memory(gb, 0xFE00 + ((i * 4) + 0));
+        BYTE xPos = read_memory(gb, 0xFE00 + ((i * 4) + 1));
+        BYTE tile_num = read_memory(gb, 0xFE00 + ((i * 4) + 2));
+        BYTE flags = read_memory(gb, 0xFE00 + ((i * 4) + 3));
         
         if (sprite_size = 8) {
             if (scanline < (yPos - 16) || scanline > (yPos - 16 + 7)) {
@@ -244,9 +261,9 @@ void draw_sprites() {
 
         int sprite_row = scanline - (yPos - 16);
         /* Retrieve the tile data lower byte */
-        BYTE tile_data_lb = read_memory((tile_num * 16) + sprite_row + 0x8000);
+        BYTE tile_data_lb = read_memory(gb, (tile_num * 16) + sprite_row + 0x8000);
         /* Retrieve the tile data upper byte */
-        BYTE tile_data_ub = read_memory((tile_num * 16) + sprite_row + 0x8000 + 1);
+        BYTE tile_data_ub = read_memory(gb, (tile_num * 16) + sprite_row + 0x8000 + 1);
 
         // Draw 8 pixels for the row of tile data
         for (int i = 7; i >= 0; i--) {
@@ -254,16 +271,16 @@ void draw_sprites() {
                 continue;
             }
             int color_number = (test_bit(i, &tile_data_ub) << 1)  | test_bit(i, &tile_data_lb);
-            screen[(scanline * WIDTH) + (xPos - 8) + (7 - i)] = get_color(color_number);
+            gb->screen[(scanline * WIDTH) + (xPos - 8) + (7 - i)] = get_color(gb, color_number);
         }
     }
 }
 
-unsigned int get_color(int color_number){
+unsigned int get_color(GameBoy *gb, int color_number){
     unsigned int color = 0;
     
     // Retreive Palette Data
-    BYTE palette = read_memory(0xFF47);
+    BYTE palette = read_memory(gb, 0xFF47);
     BYTE number = (palette >> (2 * color_number)) & 0x03;
 
     switch (number) {
@@ -283,21 +300,23 @@ unsigned int get_color(int color_number){
     return color;
 }
 
-int get_stat_mode(void) {
-    return (rom[STATUS] & 0x03);
+int get_stat_mode(GameBoy *gb) {
+    return (gb->rom[STATUS] & 0x03);
 }
 
-void set_stat_mode(unsigned int mode) {
+void set_stat_mode(GameBoy *gb, unsigned int mode) {
     if (mode > 3) {
         return;
     }
     // Clear mode
-    rom[STATUS] &= ~(0x03);
+    gb->rom[STATUS] &= ~(0x03);
     // Set mode
-    rom[STATUS] |= mode;
+    gb->rom[STATUS] |= mode;
+    map_video_memory(gb, mode);
 }
 
-int display_init() {
+int display_init(GameBoy *gb) {
+    display_gb = gb;
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -367,20 +386,20 @@ int display_init() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, WIDTH, HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, screen);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, WIDTH, HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, gb->screen);
 
     glUseProgram(program);
     return 0;
     
 }
 
-void render_display() {
+void render_display(GameBoy *gb) {
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
     //glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, texture);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, screen);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, gb->screen);
 
     // render container
     glUseProgram(program);
@@ -394,6 +413,10 @@ GLFWwindow* get_window() {
     return window;
 }
 
+int display_closed(void) {
+    return glfwWindowShouldClose(window);
+}
+
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
     // make sure the viewport matches the new window dimensions; note that width and 
@@ -470,38 +493,39 @@ int parse_file_into_str(const char *file_name, char *shader_str, int max_len) {
 }
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods) {
+    GameBoy *gb = display_gb;
     // Handle Direction Keys
-    if (check_state()) {
+    if (check_state(gb)) {
         switch (key) {
             // Right
         case GLFW_KEY_D:
             if (action == GLFW_PRESS) {
-                cpu_reset_bit(0, &rom[0xFF00]);
+                cpu_reset_bit(0, &gb->rom[0xFF00]);
             }
             else if (action == GLFW_RELEASE) {
-                cpu_set_bit(0, &rom[0xFF00]);
+                cpu_set_bit(0, &gb->rom[0xFF00]);
             }
             break;
             // Left
         case GLFW_KEY_A:
             if (action == GLFW_PRESS)
-                cpu_reset_bit(1, &rom[0xFF00]);
+                cpu_reset_bit(1, &gb->rom[0xFF00]);
             else if (action == GLFW_RELEASE)
-                cpu_set_bit(1, &rom[0xFF00]);
+                cpu_set_bit(1, &gb->rom[0xFF00]);
             break;
             // Up
         case GLFW_KEY_W:
             if (action == GLFW_PRESS)
-                cpu_reset_bit(2, &rom[0xFF00]);
+                cpu_reset_bit(2, &gb->rom[0xFF00]);
             else if (action == GLFW_RELEASE)
-                cpu_set_bit(2, &rom[0xFF00]);
+                cpu_set_bit(2, &gb->rom[0xFF00]);
             break;
             // Down
         case GLFW_KEY_S:
             if (action == GLFW_PRESS)
-                cpu_reset_bit(3, &rom[0xFF00]);
+                cpu_reset_bit(3, &gb->rom[0xFF00]);
             else if (action == GLFW_RELEASE)
-                cpu_set_bit(3, &rom[0xFF00]);
+                cpu_set_bit(3, &gb->rom[0xFF00]);
             break;
         }
     }
@@ -511,38 +535,38 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
             // A
         case GLFW_KEY_LEFT:
             if (action == GLFW_PRESS)
-                cpu_reset_bit(0, &rom[0xFF00]);
+                cpu_reset_bit(0, &gb->rom[0xFF00]);
             else if (action == GLFW_RELEASE)
-                cpu_set_bit(0, &rom[0xFF00]);
+                cpu_set_bit(0, &gb->rom[0xFF00]);
             break;
             // B
         case GLFW_KEY_UP:
             if (action == GLFW_PRESS)
-                cpu_reset_bit(1, &rom[0xFF00]);
+                cpu_reset_bit(1, &gb->rom[0xFF00]);
             else if (action == GLFW_RELEASE)
-                cpu_set_bit(1, &rom[0xFF00]);
+                cpu_set_bit(1, &gb->rom[0xFF00]);
             break;
             // Start
         case GLFW_KEY_ENTER:
             if (action == GLFW_PRESS)
-                cpu_reset_bit(2, &rom[0xFF00]);
+                cpu_reset_bit(2, &gb->rom[0xFF00]);
             else if (action == GLFW_RELEASE)
-                cpu_set_bit(2, &rom[0xFF00]);
+                cpu_set_bit(2, &gb->rom[0xFF00]);
             break;
             // Select
         case GLFW_KEY_SPACE:
             if (action == GLFW_PRESS)
-                cpu_reset_bit(3, &rom[0xFF00]);
+                cpu_reset_bit(3, &gb->rom[0xFF00]);
             else if (action == GLFW_RELEASE)
-                cpu_set_bit(3, &rom[0xFF00]);
+                cpu_set_bit(3, &gb->rom[0xFF00]);
             break;
         }
     }
 }
 
 
-int check_state() {
-    BYTE Joypad = rom[0xFF00];
+int check_state(GameBoy *gb) {
+    BYTE Joypad = gb->rom[0xFF00];
     // Test for Direction Keys
     if (test_bit(4, &Joypad)) {
         return 1;
@@ -4,14 +4,18 @@
 #include "instructions.h"
 
 #define LCD_Control 0xFF40
-int display_init();
-int check_state();
-unsigned int get_color(int color_number);
-int get_stat_mode(void);
-void set_stat_mode(unsigned int mode);
-void render_display();
-void draw(int cycles);
-void draw_scanline(void);
-void draw_tile(void);
-void draw_sprites(void);
+
+int display_init(GameBoy *gb);
+int check_state(GameBoy *gb);
+unsigned int get_color(GameBoy *gb, int color_number);
+int get_stat_mode(GameBoy *gb);
+void set_stat_mode(GameBoy *gb, unsigned int mode);
+void render_display(GameBoy *gb);
+/* Non-zero once the window has been asked to close */
+int display_closed(void);
+void draw(GameBoy *gb, int cycles);
+int cycles_until_mode_change(GameBoy *gb);
+void draw_scanline(GameBoy *gb);
+void draw_tile(GameBoy *gb);
+void draw_sprites(GameBoy *gb);
 #endif // !DISPLAY_H
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include <string.h>
+#include "gameboy.h"
+#include "dma.h"
+#include "display.h"
+#include "memory_map.h"
+#include "scheduler.h"
+
+/*  OAM DMA
+    A write to 0xFF46 copies 160 bytes from XX00-XX9F to OAM, one byte every 4 cycles, so the transfer
+    runs alongside the CPU for 640 cycles. Nothing is copied while it runs until something could see
+    OAM part way through, or the transfer ends with EVENT_DMA. Then every byte that is due by
+    total_cycles is copied at once with memcpy() from the source page.
+
+    While a transfer runs, the OAM page is taken out of the page tables. Reads of OAM go through
+    read_memory(), which catches the transfer up first, and that is also how the PPU sees the sprites.
+    Writes to OAM are dropped, as on hardware. Bytes are read from the source when they are copied,
+    so the source should not change while the transfer runs, which games wait out in High RAM anyway.
+*/
+
+#define OAM 0xFE00
+#define DMA_LENGTH 0xA0
+#define DMA_CYCLES_PER_BYTE 4
+
+void dma_start(GameBoy *gb, BYTE page) {
+    // A new transfer cuts the running one short. dma_sync() counts one that finished already
+    dma_sync(gb);
+    if (gb->dma_active)
+        gb->dma_cycles += gb->total_cycles - gb->dma_start;
+    gb->dma_source = page << 8;
+    gb->dma_start = gb->total_cycles;
+    gb->dma_copied = 0;
+    gb->dma_active = 1;
+    map_video_memory(gb, get_stat_mode(gb));
+    schedule_event(gb, EVENT_DMA, gb->total_cycles + DMA_LENGTH * DMA_CYCLES_PER_BYTE);
+}
+
+void dma_sync(GameBoy *gb) {
+    if (!gb->dma_active)
+        return;
+    unsigned long long due = (gb->total_cycles - gb->dma_start) / DMA_CYCLES_PER_BYTE;
+    if (due > DMA_LENGTH)
+        due = DMA_LENGTH;
+
+    // The transfer never leaves its source page, which is read from the memory behind it without side effects
+    const BYTE *source = gb->memory_page[gb->dma_source >> 8];
+    memcpy(&gb->rom[OAM + gb->dma_copied], source + gb->dma_copied, (size_t)due - gb->dma_copied);
+    gb->dma_copied = (BYTE)due;
+
+    if (due == DMA_LENGTH) {
+        gb->dma_active = 0;
+        gb->dma_cycles += DMA_LENGTH * DMA_CYCLES_PER_BYTE;
+        map_video_memory(gb, get_stat_mode(gb));
+    }
+}
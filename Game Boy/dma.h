@@ -0,0 +1,11 @@
+#ifndef DMA_H
+#define DMA_H
+#include "cpu.h"
+
+/* Start copying the 160 bytes from page << 8 to OAM, which takes 640 cycles. Called on writes to 0xFF46 */
+void dma_start(GameBoy *gb, BYTE page);
+
+/* Copy every byte of the running transfer that is due by total_cycles */
+void dma_sync(GameBoy *gb);
+
+#endif
@@ -0,0 +1,150 @@
+#include <stdlib.h>
+#include <string.h>
+#include "gameboy.h"
+#include "display.h"
+#include "scheduler.h"
+#include "emulator.h"
+#include "flags.h"
+#include "idle_loop.h"
+#include "block_cache.h"
+#include "jit.h"
+#include "aot.h"
+#include "threaded.h"
+#include "cartridge.h"
+#include "battery.h"
+
+GameBoy *create_gameboy(void) {
+    alu_tables_init();
+    GameBoy *gb = calloc(1, sizeof(GameBoy));
+#if BLOCK_CACHE
+    if (gb != NULL && block_cache_init(gb) != 0) {
+        free(gb);
+        return NULL;
+    }
+#endif
+    return gb;
+}
+
+void destroy_gameboy(GameBoy *gb) {
+    if (gb == NULL)
+        return;
+    battery_close(gb);
+    cartridge_unload(gb);
+#if BLOCK_CACHE
+    block_cache_free(gb);
+#endif
+#if JIT
+    jit_free(gb);
+#endif
+    free(gb);
+}
+
+int set_engine(GameBoy *gb, ENGINE engine) {
+#if JIT
+    gb->engine = engine;
+    return 0;
+#else
+    return engine != ENGINE_INTERPRETER;
+#endif
+}
+
+void set_battery_saves(GameBoy *gb, int enabled) {
+    gb->battery_saves = enabled != 0;
+}
+
+int power_on(GameBoy *gb, char *filename) {
+    // A reused instance starts out with the same memory, PPU and timer phase as a new one
+    memset(gb->rom, 0, sizeof(gb->rom));
+    gb->prev_mode = 0;
+    gb->mode_clock = 0;
+    gb->frame_ready = 0;
+    gb->timer_cycles = 0;
+    gb->divider_cycles = 0;
+    gb->timer_clock = 0;
+    cpu_init(gb);
+    scheduler_init(gb);
+    gb->idle_cycles_skipped = 0;
+    gb->dma_cycles = 0;
+#if BLOCK_CACHE
+    block_cache_reset(gb);
+#endif
+    if (load_rom(gb, filename) == 1)
+        return 1;
+    aot_attach(gb);
+    return 0;
+}
+
+#if AOT || !THREADED
+/* Look for an idle loop if the instruction at pc, the last one run, jumped back */
+static void check_idle_loop(GameBoy *gb, WORD pc) {
+#if IDLE_LOOP_SKIP
+    if (gb->PC <= pc)
+        idle_loop_check(gb, pc);
+#endif
+}
+#endif
+
+/* Run the next instruction, or the next block of them */
+static void run_instructions(GameBoy *gb) {
+#if AOT
+    int last = aot_run_block(gb);
+    if (last >= 0) {
+        check_idle_loop(gb, (WORD)last);
+        return;
+    }
+#endif
+#if THREADED
+    // Runs on through jumps back and looks for idle loops itself
+    run_threaded(gb);
+#elif BLOCK_CACHE
+    check_idle_loop(gb, execute_block(gb));
+#else
+    WORD pc = gb->PC;
+    gb->total_cycles += execute(gb);
+    check_idle_loop(gb, pc);
+#endif
+}
+
+/* Run instructions up to the given cycle, or up to an event that an instruction schedules before it,
+   which lowers stop_cycle. Nothing can wake a halted CPU before the next event, so the clock jumps
+   straight to stop_cycle and the event is serviced on the cycle it is due */
+static void run_until(GameBoy *gb, unsigned long long limit) {
+#if IDLE_LOOP_SKIP
+    idle_loop_reset(gb);
+#endif
+    gb->stop_cycle = limit < gb->next_event ? limit : gb->next_event;
+    while (gb->total_cycles < gb->stop_cycle) {
+        if (gb->HALT) {
+            gb->total_cycles = gb->stop_cycle;
+            return;
+        }
+        run_instructions(gb);
+    }
+}
+
+unsigned int run_cycles(GameBoy *gb, unsigned int budget) {
+    unsigned long long start = gb->total_cycles;
+    unsigned long long end = start + budget;
+
+    while (gb->total_cycles < end) {
+        run_until(gb, end);
+        run_events(gb);
+    }
+    return (unsigned int)(gb->total_cycles - start);
+}
+
+unsigned int run_frame(GameBoy *gb) {
+    unsigned long long start = gb->total_cycles;
+    gb->frame_ready = 0;
+
+    while (!gb->frame_ready) {
+        run_until(gb, NEVER);
+        run_events(gb);
+
+        // There is no V-Blank while the LCD is off, so stop after a frame's worth of cycles
+        if (test_bit(7, &gb->rom[LCD_Control]) == 0 && gb->total_cycles - start >= CYCLES_PER_FRAME) {
+            break;
+        }
+    }
+    return (unsigned int)(gb->total_cycles - start);
+}
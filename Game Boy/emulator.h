@@ -0,0 +1,43 @@
+#ifndef EMULATOR_H
+#define EMULATOR_H
+#include "cpu.h"
+
+/* One frame is 154 scanlines of 456 cycles */
+#define CYCLES_PER_FRAME 70224
+
+/* Allocate a new powered off instance. Returns NULL if out of memory. Safe to call from several threads
+   at once, as are power_on() and destroy_gameboy() on different instances */
+GameBoy *create_gameboy(void);
+
+void destroy_gameboy(GameBoy *gb);
+
+/* How instructions are run. ENGINE_JIT_CHECK runs every compiled block in the interpreter as well
+   and reports any difference in the registers, the cycle count or memory on stderr */
+typedef enum {
+    ENGINE_INTERPRETER,
+    ENGINE_JIT,
+    ENGINE_JIT_CHECK
+} ENGINE;
+
+/* Returns 1 if this build has no JIT, in which case the interpreter keeps being used */
+int set_engine(GameBoy *gb, ENGINE engine);
+
+/* Load the .sav of a cartridge with a battery when powered on, and write the RAM back to it while
+   running and when the cartridge is closed. Off for a new instance, so batch runs and tools leave the
+   player's saves alone. Takes effect from the next power_on() */
+void set_battery_saves(GameBoy *gb, int enabled);
+
+/* Reset the CPU, PPU, timer, scheduler and memory, including work and video RAM, and load the
+   cartridge. An instance that is powered on again runs exactly as a new one would.
+   Returns 1 if the ROM could not be loaded */
+int power_on(GameBoy *gb, char *filename);
+
+/* Run for at least the given number of cycles. Returns the number of cycles actually run,
+   which can go over the budget by the length of the last instruction */
+unsigned int run_cycles(GameBoy *gb, unsigned int budget);
+
+/* Run until the PPU enters V-Blank and the screen buffer holds a complete frame.
+   Returns the number of cycles run */
+unsigned int run_frame(GameBoy *gb);
+
+#endif
@@ -0,0 +1,191 @@
+#include "gameboy.h"
+#include "instructions.h"
+#include "flags.h"
+
+#if FLAG_MODE == FLAGS_LAZY
+
+/*  Lazy flags
+    The ALU helpers below only record the operation, its operands and its result. Most of the time
+    the next ALU instruction overwrites the flags before anything looks at them, so they are only
+    worked out when F is read: by a conditional jump, call or return, PUSH AF, DAA, ADC/SBC, or
+    any instruction that changes some of the flags and keeps the rest. BIT and ADD HL keep only one
+    flag, so they ask get_flag() for it and leave the rest unworked.
+    The flags are worked out exactly as the eager helpers in instructions.c do.
+*/
+
+static void record(GameBoy *gb, FLAG_OP op, BYTE a, BYTE b, BYTE carry, BYTE result) {
+    gb->flag_op = op;
+    gb->flag_a = a;
+    gb->flag_b = b;
+    gb->flag_carry = carry;
+    gb->flag_result = result;
+}
+
+static int lazy_carry(GameBoy *gb) {
+    BYTE a = gb->flag_a;
+    BYTE b = gb->flag_b;
+    switch (gb->flag_op) {
+    case FLAG_OP_ADD: return a + b > 0xFF;
+    case FLAG_OP_ADC: return a + b + gb->flag_carry > 0xFF;
+    case FLAG_OP_SUB: return a < b;
+    case FLAG_OP_SBC: return a - b - gb->flag_carry < 0;
+    case FLAG_OP_INC:
+    case FLAG_OP_DEC: return gb->flag_carry;
+    case FLAG_OP_NONE: return test_bit(FLAG_C, &gb->RegAF.lo);
+    default: return 0;
+    }
+}
+
+static int lazy_half_carry(GameBoy *gb) {
+    BYTE a = gb->flag_a & 0x0F;
+    BYTE b = gb->flag_b & 0x0F;
+    switch (gb->flag_op) {
+    case FLAG_OP_ADD: return a + b > 0x0F;
+    case FLAG_OP_ADC: return a + b + gb->flag_carry > 0x0F;
+    case FLAG_OP_SUB: return a < b;
+    case FLAG_OP_SBC: return a - b - gb->flag_carry < 0;
+    case FLAG_OP_AND: return 1;
+    case FLAG_OP_INC: return a == 0x0F;
+    case FLAG_OP_DEC: return a == 0;
+    case FLAG_OP_NONE: return test_bit(FLAG_H, &gb->RegAF.lo);
+    default: return 0;
+    }
+}
+
+void materialise_flags(GameBoy *gb) {
+    // One pass over the operation, where asking lazy_half_carry() and lazy_carry() in turn switches twice
+    unsigned int a = gb->flag_a;
+    unsigned int b = gb->flag_b;
+    unsigned int carry = gb->flag_carry;
+    BYTE f = gb->flag_result == 0 ? 1 << FLAG_Z : 0;
+
+    switch (gb->flag_op) {
+    case FLAG_OP_ADD:
+        carry = 0;
+        // fall through
+    case FLAG_OP_ADC:
+        if ((a & 0x0F) + (b & 0x0F) + carry > 0x0F)
+            f |= 1 << FLAG_H;
+        if (a + b + carry > 0xFF)
+            f |= 1 << FLAG_C;
+        break;
+    case FLAG_OP_SUB:
+        carry = 0;
+        // fall through
+    case FLAG_OP_SBC:
+        f |= 1 << FLAG_N;
+        if ((a & 0x0F) < (b & 0x0F) + carry)
+            f |= 1 << FLAG_H;
+        if (a < b + carry)
+            f |= 1 << FLAG_C;
+        break;
+    case FLAG_OP_AND:
+        f |= 1 << FLAG_H;
+        break;
+    case FLAG_OP_INC:
+        if ((a & 0x0F) == 0x0F)
+            f |= 1 << FLAG_H;
+        f |= carry << FLAG_C;
+        break;
+    case FLAG_OP_DEC:
+        f |= 1 << FLAG_N;
+        if ((a & 0x0F) == 0)
+            f |= 1 << FLAG_H;
+        f |= carry << FLAG_C;
+        break;
+    case FLAG_OP_NONE:
+        return;
+    default:
+        break;
+    }
+
+    gb->RegAF.lo = f;
+    gb->flag_op = FLAG_OP_NONE;
+}
+
+int get_flag(GameBoy *gb, BYTE flag) {
+    if (gb->flag_op == FLAG_OP_NONE)
+        return test_bit(flag, &gb->RegAF.lo);
+
+    switch (flag) {
+    case FLAG_Z: return gb->flag_result == 0;
+    case FLAG_H: return lazy_half_carry(gb);
+    case FLAG_C: return lazy_carry(gb);
+    default:
+        materialise_flags(gb);
+        return test_bit(flag, &gb->RegAF.lo);
+    }
+}
+
+void cpu_add(GameBoy *gb, BYTE n) {
+    BYTE a = gb->RegAF.hi;
+    gb->RegAF.hi = a + n;
+    record(gb, FLAG_OP_ADD, a, n, 0, gb->RegAF.hi);
+}
+
+void cpu_adc(GameBoy *gb, BYTE n) {
+    BYTE carry_flag = get_flag(gb, FLAG_C);
+    BYTE a = gb->RegAF.hi;
+    gb->RegAF.hi = a + n + carry_flag;
+    record(gb, FLAG_OP_ADC, a, n, carry_flag, gb->RegAF.hi);
+}
+
+void cpu_sub(GameBoy *gb, BYTE n) {
+    BYTE a = gb->RegAF.hi;
+    gb->RegAF.hi = a - n;
+    record(gb, FLAG_OP_SUB, a, n, 0, gb->RegAF.hi);
+}
+
+void cpu_sbc(GameBoy *gb, BYTE n) {
+    BYTE carry_flag = get_flag(gb, FLAG_C);
+    BYTE a = gb->RegAF.hi;
+    gb->RegAF.hi = a - n - carry_flag;
+    record(gb, FLAG_OP_SBC, a, n, carry_flag, gb->RegAF.hi);
+}
+
+void cpu_and(GameBoy *gb, BYTE n) {
+    gb->RegAF.hi &= n;
+    record(gb, FLAG_OP_AND, 0, 0, 0, gb->RegAF.hi);
+}
+
+void cpu_or(GameBoy *gb, BYTE n) {
+    gb->RegAF.hi |= n;
+    record(gb, FLAG_OP_OR, 0, 0, 0, gb->RegAF.hi);
+}
+
+void cpu_xor(GameBoy *gb, BYTE n) {
+    gb->RegAF.hi ^= n;
+    record(gb, FLAG_OP_OR, 0, 0, 0, gb->RegAF.hi);
+}
+
+void cpu_cp(GameBoy *gb, BYTE n) {
+    record(gb, FLAG_OP_SUB, gb->RegAF.hi, n, 0, gb->RegAF.hi - n);
+}
+
+BYTE cpu_inc(GameBoy *gb, BYTE n) {
+    BYTE carry_flag = lazy_carry(gb);  // INC keeps the carry flag
+    record(gb, FLAG_OP_INC, n, 0, carry_flag, n + 1);
+    return n + 1;
+}
+
+void cpu_inc_hl(GameBoy *gb, WORD address) {
+    BYTE n = read_memory(gb, address);
+    BYTE carry_flag = lazy_carry(gb);
+    write_memory(gb, address, n + 1);
+    record(gb, FLAG_OP_INC, n, 0, carry_flag, n + 1);
+}
+
+BYTE cpu_dec(GameBoy *gb, BYTE n) {
+    BYTE carry_flag = lazy_carry(gb);  // DEC keeps the carry flag
+    record(gb, FLAG_OP_DEC, n, 0, carry_flag, n - 1);
+    return n - 1;
+}
+
+void cpu_dec_hl(GameBoy *gb, WORD address) {
+    BYTE n = read_memory(gb, address);
+    BYTE carry_flag = lazy_carry(gb);
+    write_memory(gb, address, n - 1);
+    record(gb, FLAG_OP_DEC, n, 0, carry_flag, n - 1);
+}
+
+#endif
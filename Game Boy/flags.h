@@ -0,0 +1,50 @@
+#ifndef FLAGS_H
+#define FLAGS_H
+#include "cpu.h"
+
+/* The ALU operation recorded in place of the flags register when FLAG_MODE is FLAGS_LAZY */
+typedef enum {
+    FLAG_OP_NONE,   // F holds the flags
+    FLAG_OP_ADD,
+    FLAG_OP_ADC,
+    FLAG_OP_SUB,    // Also CP
+    FLAG_OP_SBC,
+    FLAG_OP_AND,
+    FLAG_OP_OR,     // Also XOR
+    FLAG_OP_INC,
+    FLAG_OP_DEC
+} FLAG_OP;
+
+#if FLAG_MODE == FLAGS_LAZY
+
+/* Work out Z/N/H/C from the recorded operation and store them in F */
+void materialise_flags(GameBoy *gb);
+
+/* Returns 1 if the flag is set. Only works out the one flag, F is left as it is */
+int get_flag(GameBoy *gb, BYTE flag);
+
+/* Call before anything reads or changes only some of the bits in F */
+#define sync_flags(gb) do { if ((gb)->flag_op != FLAG_OP_NONE) materialise_flags(gb); } while (0)
+
+/* Call before anything overwrites all of F */
+#define discard_flags(gb) ((gb)->flag_op = FLAG_OP_NONE)
+
+#define alu_tables_init() ((void)0)
+
+#else
+
+#define get_flag(gb, flag) test_bit(flag, &(gb)->RegAF.lo)
+#define sync_flags(gb) ((void)0)
+#define discard_flags(gb) ((void)0)
+
+#if FLAG_MODE == FLAGS_TABLE
+/* Build the ALU lookup tables. Called by create_gameboy() before the first instance runs. Safe to call
+   from several threads at once */
+void alu_tables_init(void);
+#else
+#define alu_tables_init() ((void)0)
+#endif
+
+#endif
+
+#endif
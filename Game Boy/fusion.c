@@ -0,0 +1,178 @@
+#include <string.h>
+#include "gameboy.h"
+#include "fusion.h"
+#include "memory_map.h"
+
+/*  Superinstructions
+    Games spend their load phases in a handful of tight loops that copy or clear VRAM and work RAM,
+    or count a register down. A block that is one of those loops is marked when it is decoded, and
+    the next time it runs every pass but the last is done at once: the counter, HL and DE are moved
+    on by the number of passes, memory is copied or filled with memmove()/memset() one page at a time
+    and total_cycles goes up by the cycles of that many passes. The last pass then runs through the
+    handlers, which leaves A and the flags exactly as the interpreter would, since every pass sets
+    them again from scratch and DEC r keeps the carry flag from before the loop.
+
+    The cycles of one pass are the same every time (JR NZ takes 8 cycles whether or not it jumps),
+    and passes only run in bulk up to stop_cycle, so events happen on the same cycle as before. Bulk
+    passes only touch plain memory, so they cannot schedule an event that would lower it.
+*/
+
+static BYTE *reg8(GameBoy *gb, int index) {
+    switch (index) {
+    case REGB: return &gb->RegBC.hi;
+    case REGC: return &gb->RegBC.lo;
+    case REGD: return &gb->RegDE.hi;
+    case REGE: return &gb->RegDE.lo;
+    case REGH: return &gb->RegHL.hi;
+    case REGL: return &gb->RegHL.lo;
+    default: return &gb->RegAF.hi;
+    }
+}
+
+/* Opcode of the nth instruction of the block, or -1 for CB prefixed instructions */
+static int opcode_at(const Block *block, int n) {
+    const MicroOp *op = &block->ops[n];
+    return op->operands == (WORD)(op->pc + 1) ? op->opcode : -1;
+}
+
+/* 1 if the instructions from first on are DEC r with r one of the allowed registers, then JR NZ to the start */
+static int ends_in_countdown(GameBoy *gb, const Block *block, int first, const char *allowed) {
+    if (block->count != first + 2)
+        return 0;
+    int dec = opcode_at(block, first);
+    const MicroOp *jr = &block->ops[first + 1];
+    if (dec < 0 || (dec & 0xC7) != 0x05 || strchr(allowed, "bcdehl-a"[(dec >> 3) & 0x07]) == NULL)
+        return 0;
+    return opcode_at(block, first + 1) == 0x20
+        && (WORD)(jr->pc + 2 + (SIGNED_BYTE)MEMORY_AT(gb, jr->pc + 1)) == block->start;
+}
+
+void fusion_detect(GameBoy *gb, Block *block) {
+    static const int copy_bc[] = { 0x2A, 0x12, 0x13, 0x0B, 0x78, 0xB1, 0x20 };
+    int first = opcode_at(block, 0) == 0xAF ? 1 : 0;
+
+    block->fusion = FUSION_NONE;
+    if (ends_in_countdown(gb, block, 0, "bcdehla")) {
+        block->fusion = FUSION_COUNT;
+    }
+    else if (block->count == 5 && opcode_at(block, 0) == 0x2A && opcode_at(block, 1) == 0x12
+        && opcode_at(block, 2) == 0x13 && ends_in_countdown(gb, block, 3, "bc")) {
+        block->fusion = FUSION_COPY;
+    }
+    else if ((opcode_at(block, first) == 0x22 || opcode_at(block, first) == 0x32)
+        && ends_in_countdown(gb, block, first + 1, "bcde")) {
+        block->fusion = FUSION_CLEAR;
+    }
+    else if (block->count == 7) {
+        for (int i = 0; i < 7; i++) {
+            if (opcode_at(block, i) != copy_bc[i])
+                return;
+        }
+        if ((WORD)(block->ops[6].pc + 2 + (SIGNED_BYTE)MEMORY_AT(gb, block->ops[6].pc + 1)) == block->start)
+            block->fusion = FUSION_COPY_BC;
+    }
+    if (block->fusion != FUSION_NONE)
+        block->fusion_reg = (block->ops[block->count - 2].opcode >> 3) & 0x07;
+}
+
+/* 1 if every page from address for length bytes can be accessed through the page table */
+static int plain_memory(BYTE **pages, unsigned int address, unsigned int length) {
+    if (address + length > 0x10000)
+        return 0;
+    for (unsigned int page = address >> 8; page <= (address + length - 1) >> 8; page++) {
+        if (pages[page] == NULL)
+            return 0;
+    }
+    return 1;
+}
+
+/* Copy like a loop of single byte loads and stores going up from dst and src would.
+   Returns 0 without copying anything if that cannot be done with the page table */
+static int bulk_copy(GameBoy *gb, unsigned int dst, unsigned int src, unsigned int length) {
+    // A byte by byte copy into a range it has yet to read repeats the start of the source
+    if (dst > src && dst < src + length)
+        return 0;
+    if (!plain_memory(gb->read_page, src, length) || !plain_memory(gb->write_page, dst, length))
+        return 0;
+    while (length > 0) {
+        unsigned int chunk = length;
+        if (chunk > 0x100 - (src & 0xFF))
+            chunk = 0x100 - (src & 0xFF);
+        if (chunk > 0x100 - (dst & 0xFF))
+            chunk = 0x100 - (dst & 0xFF);
+        memmove(gb->write_page[dst >> 8] + (dst & 0xFF), gb->read_page[src >> 8] + (src & 0xFF), chunk);
+        src += chunk;
+        dst += chunk;
+        length -= chunk;
+    }
+    return 1;
+}
+
+/* Fill length bytes from first on. Returns 0 without writing anything if that cannot be done with the page table */
+static int bulk_fill(GameBoy *gb, unsigned int first, BYTE value, unsigned int length) {
+    if (!plain_memory(gb->write_page, first, length))
+        return 0;
+    while (length > 0) {
+        unsigned int chunk = length;
+        if (chunk > 0x100 - (first & 0xFF))
+            chunk = 0x100 - (first & 0xFF);
+        memset(gb->write_page[first >> 8] + (first & 0xFF), value, chunk);
+        first += chunk;
+        length -= chunk;
+    }
+    return 1;
+}
+
+void fusion_run(GameBoy *gb, Block *block) {
+    unsigned long long limit = gb->stop_cycle;
+    unsigned int cycles = block->body_cycles + block->ops[block->count - 1].cycles;
+    if (cycles == 0 || gb->total_cycles + cycles > limit)
+        return;
+
+    // Passes left before the counter reaches 0, and passes that start before the limit
+    BYTE *counter = reg8(gb, block->fusion_reg);
+    unsigned int passes = block->fusion == FUSION_COPY_BC
+        ? (gb->RegBC.data ? gb->RegBC.data : 0x10000)
+        : (*counter ? *counter : 0x100);
+    unsigned long long fit = (limit - gb->total_cycles) / cycles;
+    if (passes > fit)
+        passes = (unsigned int)fit;
+    if (passes <= 1)
+        return;
+    passes--;
+
+    switch (block->fusion) {
+    case FUSION_COUNT:
+        break;
+    case FUSION_COPY:
+    case FUSION_COPY_BC:
+        if (!bulk_copy(gb, gb->RegDE.data, gb->RegHL.data, passes))
+            return;
+        gb->RegHL.data += passes;
+        gb->RegDE.data += passes;
+        break;
+    case FUSION_CLEAR: {
+        BYTE value = opcode_at(block, 0) == 0xAF ? 0 : gb->RegAF.hi;
+        if (opcode_at(block, block->count - 3) == 0x22) {
+            if (!bulk_fill(gb, gb->RegHL.data, value, passes))
+                return;
+            gb->RegHL.data += passes;
+        }
+        else {
+            unsigned int last = gb->RegHL.data;
+            if (last + 1 < passes || !bulk_fill(gb, last + 1 - passes, value, passes))
+                return;
+            gb->RegHL.data -= passes;
+        }
+        break;
+    }
+    default:
+        return;
+    }
+
+    if (block->fusion == FUSION_COPY_BC)
+        gb->RegBC.data -= passes;
+    else
+        *counter -= passes;
+    gb->total_cycles += (unsigned long long)passes * cycles;
+}
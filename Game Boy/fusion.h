@@ -0,0 +1,23 @@
+#ifndef FUSION_H
+#define FUSION_H
+#include "cpu.h"
+#include "block_cache.h"
+
+/* Loops that are run many passes at a time */
+typedef enum {
+    FUSION_NONE,
+    FUSION_COUNT,       // DEC r / JR NZ
+    FUSION_COPY,        // LD A, (HL+) / LD (DE), A / INC DE / DEC r / JR NZ
+    FUSION_COPY_BC,     // LD A, (HL+) / LD (DE), A / INC DE / DEC BC / LD A, B / OR C / JR NZ
+    FUSION_CLEAR        // [XOR A] / LD (HL+), A or LD (HL-), A / DEC r / JR NZ
+} FUSION_KIND;
+
+/* Set the block's fusion if it is one of the loops above, ending in a JR NZ back to its start */
+void fusion_detect(GameBoy *gb, Block *block);
+
+/* Run as many passes of the loop at PC as fit before stop_cycle, leaving the last one of them for the
+   caller to run as usual. Passes that copy or fill memory only run in bulk if every page they touch
+   is plain memory */
+void fusion_run(GameBoy *gb, Block *block);
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef GAMEBOY_H
+#define GAMEBOY_H
+#include "cpu.h"
+#include "scheduler.h"
+
+/* Everything one emulated Game Boy needs. Each instance is independent, so any number of them
+   can run in the same process as long as each one is only used by one thread at a time */
+struct GameBoy {
+    /* CPU */
+    Register RegAF;
+    Register RegBC;
+    Register RegDE;
+    Register RegHL;
+    Register RegSP;
+    WORD PC;
+    BYTE opcode;
+    BYTE IME;               // Interrupt Master Enable Flag
+    BYTE HALT;
+    BYTE pending_interrupts;    // IE & IF, bits 0-4 (interrupts.c)
+
+    /* Last ALU operation, used instead of F while flag_op is not FLAG_OP_NONE (flags.c) */
+    BYTE flag_op;
+    BYTE flag_a;
+    BYTE flag_b;
+    BYTE flag_carry;        // Carry in for ADC/SBC, carry kept by INC/DEC
+    BYTE flag_result;
+
+    /* Memory */
+    BYTE *read_page[0x100];     // Base of each 256 byte page, or NULL if it needs a handler (memory_map.c)
+    BYTE *write_page[0x100];
+    BYTE *memory_page[0x100];   // Memory behind each page, never NULL
+    BYTE rom[0x10000];
+    BYTE *cartridge_memory; // The whole cartridge image, up to 8 MB, padded to a power of 2 banks. Read-only
+    unsigned int cartridge_size;
+    BYTE cartridge_mapped;  // cartridge_memory is a mapping of the file rather than a buffer (cartridge.c)
+    BYTE ram_banks[0x20000];
+
+    /* Memory bank controller (mbc.c) */
+    BYTE mbc;                       // MBC_NONE, MBC_1, MBC_3 or MBC_5 (mbc.h)
+    BYTE ram_enabled;
+    BYTE banking_mode;              // MBC1 mode 1 also applies the upper bank bits to 0000-3FFF and RAM
+    WORD rom_bank;                  // ROM bank register, the lower 5 bits of the bank for MBC1
+    BYTE ram_bank;                  // RAM bank register, the upper ROM bank bits for MBC1
+    unsigned int rom_bank_mask;     // Number of ROM banks minus 1
+    unsigned int ram_size;          // Bytes of RAM on the cartridge
+    BYTE battery;                   // The cartridge keeps its RAM with a battery
+    BYTE rtc;                       // The cartridge has an MBC3 clock
+
+    /* MBC3 real time clock (rtc.c) */
+    unsigned long long rtc_seconds; // Seconds on the clock at rtc_base, from day 0 00:00:00
+    unsigned long long rtc_base;    // total_cycles when the clock read rtc_seconds
+    BYTE rtc_halt;
+    BYTE rtc_carry;                 // The day counter went past 511
+    BYTE rtc_latch_value;           // Last value written to 6000-7FFF
+    BYTE rtc_latched[5];            // Registers as of the last latch, which is what the game reads
+
+    /* Battery backed RAM (battery.c) */
+    BYTE battery_saves;             // Load and write back the .sav, off unless set_battery_saves() turned it on
+    struct SaveFile *save;          // The .sav the RAM is written back to, NULL without a battery
+    BYTE ram_dirty[0x20000 / 0x100];    // Pages of ram_banks written since they were last saved
+    unsigned int ram_dirty_pages;
+
+    /* PPU */
+    unsigned int screen[160 * 144];
+    int prev_mode;
+    int mode_clock;
+    int frame_ready;        // Set when the PPU enters V-Blank and the screen buffer holds a complete frame
+
+    /* Timer */
+    int timer_cycles;
+    int divider_cycles;
+    int timer_clock;
+
+    /* OAM DMA (dma.c) */
+    WORD dma_source;
+    BYTE dma_active;
+    BYTE dma_copied;                // Bytes of the running transfer copied to OAM so far
+    unsigned long long dma_start;   // Cycle stamp of the write to 0xFF46
+    unsigned long long dma_cycles;  // Total cycles DMA transfers have run for since power on
+
+    /* Scheduler */
+    unsigned long long total_cycles;        // Number of cycles the CPU has run since power on
+    unsigned long long next_event;          // Cycle stamp of the earliest pending event
+    unsigned long long stop_cycle;          // Where the instructions being run stop, lowered when an earlier event is scheduled
+    unsigned long long deadline[EVENT_COUNT];
+    unsigned long long last_run[EVENT_COUNT];   // Cycle stamp of the last time each event was serviced
+
+    /* Decoded blocks (block_cache.c) */
+    struct Block *blocks;
+    BYTE code_map[0x10000 / 8];     // One bit per address, set if a cached block was decoded from it
+    unsigned int block_generation;  // Incremented whenever blocks are dropped
+
+    /* Native code (jit.c) */
+    BYTE engine;                    // ENGINE_INTERPRETER, ENGINE_JIT or ENGINE_JIT_CHECK (emulator.h)
+    BYTE *jit_code;                 // JIT_CODE_SIZE bytes of executable memory, allocated on first use
+    unsigned int jit_used;
+    GameBoy *jit_shadow;            // Copy the interpreter runs each block on for ENGINE_JIT_CHECK
+    unsigned int jit_mismatches;    // Blocks ENGINE_JIT_CHECK found to differ from the interpreter
+
+    /* Statically recompiled ROM (aot.c) */
+    const struct AotProgram *aot;   // NULL unless the loaded ROM is the one the build was translated from
+
+    /* Idle loop detection (idle_loop.c) */
+    int idle_state;
+    WORD idle_start;        // Target of the backward jump being watched
+    WORD idle_branch;       // Address of the jump
+    unsigned long long idle_stamp;          // Cycle stamp of the last time the jump was taken
+    unsigned long long idle_cycles_skipped; // Total cycles skipped in idle loops since power on
+};
+
+#endif
@@ -0,0 +1,129 @@
+"""Generates opcode_list.h from opcodes.txt
+
+    python gen_opcodes.py [opcodes.txt] [opcode_list.h]
+
+Every line of the description is expanded into the opcodes it covers, and each table is written out
+as an X-macro with one entry per opcode in order:
+
+    X(opcode, operand, cycles, name, statements)
+
+operand is one of the OPERAND values in opcodes.h, cycles is what the instruction takes, name is the
+mnemonic as a printf format for its operand, and statements is the C that runs the instruction.
+Invalid opcodes get an entry too, with 0 cycles and no statements. The script stops with an error if
+two lines describe the same opcode.
+"""
+
+import os
+import re
+import sys
+
+REGISTERS = [
+    ("B", "gb->RegBC.hi"), ("C", "gb->RegBC.lo"), ("D", "gb->RegDE.hi"), ("E", "gb->RegDE.lo"),
+    ("H", "gb->RegHL.hi"), ("L", "gb->RegHL.lo"), None, ("A", "gb->RegAF.hi"),
+]
+
+# Operand token in the mnemonic, the OPERAND value it stands for and how it is printed
+OPERANDS = [
+    ("nn", "OPERAND_NN", "$%04X"),
+    ("n", "OPERAND_N", "$%02X"),
+    ("e", "OPERAND_E", "$%04X"),
+]
+
+LINE = re.compile(r"^(main|cb)\s+([01dsb]{8})\s+(\d+)\s+([^:]+?)\s*:\s*(.*)$")
+
+
+class DescriptionError(Exception):
+    pass
+
+
+def field_values(pattern, letter):
+    """Values the field written with letter can take, or [None] if the pattern has no such field"""
+    if letter * 3 not in pattern:
+        return [None]
+    if letter == "b":
+        return list(range(8))
+    return [i for i in range(8) if REGISTERS[i] is not None]
+
+
+def expand(pattern, cycles, mnemonic, statements):
+    """Yield (opcode, cycles, name, operand, statements) for every opcode the line covers"""
+    for d in field_values(pattern, "d"):
+        for s in field_values(pattern, "s"):
+            for b in field_values(pattern, "b"):
+                bits = pattern
+                name, body = mnemonic, statements
+                if d is not None:
+                    bits = bits.replace("ddd", format(d, "03b"))
+                    name = name.replace("{d}", REGISTERS[d][0])
+                    body = body.replace("{d}", REGISTERS[d][1])
+                if s is not None:
+                    bits = bits.replace("sss", format(s, "03b"))
+                    name = name.replace("{s}", REGISTERS[s][0])
+                    body = body.replace("{s}", REGISTERS[s][1])
+                if b is not None:
+                    bits = bits.replace("bbb", format(b, "03b"))
+                    name = name.replace("{b}", str(b))
+                    body = body.replace("{b}", str(b))
+                if not re.fullmatch("[01]{8}", bits) or "{" in name:
+                    raise DescriptionError("cannot expand '%s %s'" % (pattern, mnemonic))
+                operand = "OPERAND_NONE"
+                if name == "PREFIX CB":
+                    operand = "OPERAND_CB"
+                for token, kind, printed in OPERANDS:
+                    if re.search(r"\b%s\b" % token, name):
+                        operand = kind
+                        name = re.sub(r"\b%s\b" % token, printed, name)
+                        break
+                yield int(bits, 2), cycles, name, operand, body
+
+
+def parse(path):
+    tables = {"main": {}, "cb": {}}
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            match = LINE.match(line)
+            if match is None:
+                raise DescriptionError("%s:%d: cannot parse '%s'" % (path, number, line))
+            table, pattern, cycles, mnemonic, statements = match.groups()
+            for opcode, *entry in expand(pattern, int(cycles), mnemonic, statements):
+                if opcode in tables[table]:
+                    raise DescriptionError("%s:%d: %s opcode %02X is already described by '%s'"
+                                           % (path, number, table, opcode, tables[table][opcode][1]))
+                tables[table][opcode] = entry
+    return tables
+
+
+def write_table(out, macro, table):
+    out.write("#define %s(X) \\\n" % macro)
+    lines = []
+    for opcode in range(256):
+        cycles, name, operand, body = table.get(opcode, (0, "INVALID", "OPERAND_NONE", ""))
+        lines.append("    X(0x%02X, %s, %d, \"%s\", %s)" % (opcode, operand, cycles, name, body))
+    out.write(" \\\n".join(lines))
+    out.write("\n\n")
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    source = sys.argv[1] if len(sys.argv) > 1 else os.path.join(here, "opcodes.txt")
+    target = sys.argv[2] if len(sys.argv) > 2 else os.path.join(here, "opcode_list.h")
+    try:
+        tables = parse(source)
+    except DescriptionError as error:
+        sys.exit(str(error))
+
+    with open(target, "w", newline="\n") as out:
+        out.write("/* Generated by gen_opcodes.py from opcodes.txt. Edit opcodes.txt instead of this file */\n")
+        out.write("#ifndef OPCODE_LIST_H\n#define OPCODE_LIST_H\n\n")
+        out.write("/* X(opcode, operand, cycles, name, statements) for every opcode, in order */\n")
+        write_table(out, "MAIN_OPCODES", tables["main"])
+        out.write("/* The same for the opcodes after the 0xCB prefix */\n")
+        write_table(out, "CB_OPCODES", tables["cb"])
+        out.write("#endif\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,122 @@
+#include "gameboy.h"
+#include "idle_loop.h"
+#include "scheduler.h"
+
+/*  Idle loops
+    Games often wait for the PPU with a loop like
+        wait: LDH A,(0x44)
+              CP 0x90
+              JR NZ,wait
+    Each iteration loads A from an I/O or High RAM register, tests it and branches back. Nothing in the
+    loop writes memory, and the registers it polls only change when the scheduler services an event:
+    LY and STAT when the PPU changes mode, DIV and TIMA when the timer ticks, High RAM in an interrupt
+    routine. Until the next event every iteration does exactly the same thing, so they can be skipped.
+
+    A loop is only recognised when it is straight-line code from the jump target down to the backward
+    jump. Execution can only get back to the target through another backward jump, so two jumps in a row
+    from the same branch to the same target, with no event in between, are exactly one iteration apart.
+    The time between them is the length of one iteration.
+*/
+
+/* Longest loop body that is examined, in bytes */
+#define IDLE_LOOP_MAX 16
+
+enum { LOOP_NONE, LOOP_BUSY, LOOP_IDLE };
+
+/* Returns 1 if the address is an I/O or High RAM register, which only change between events */
+static int polled_address(WORD address) {
+    return address >= 0xFF00 && address != 0xFFFF;
+}
+
+/* Returns 1 if the code from start up to and including the jump at branch_pc only reads A from a
+   polled register and tests it, so that every iteration leaves the CPU in the same state */
+static int is_idle_loop(GameBoy *gb, WORD start, WORD branch_pc) {
+    WORD pc = start;
+    int a_loaded = 0;
+
+    if (branch_pc - start > IDLE_LOOP_MAX)
+        return 0;
+
+    while (pc < branch_pc) {
+        BYTE opcode = read_memory(gb, pc);
+        switch (opcode) {
+        case 0x00:          // NOP
+            pc += 1;
+            break;
+        case 0xF0:          // LDH A,(n)
+            if (!polled_address(0xFF00 + read_memory(gb, pc + 1)))
+                return 0;
+            a_loaded = 1;
+            pc += 2;
+            break;
+        case 0xFA:          // LD A,(nn)
+            if (!polled_address(read_memory(gb, pc + 1) | (read_memory(gb, pc + 2) << 8)))
+                return 0;
+            a_loaded = 1;
+            pc += 3;
+            break;
+        case 0xA7:          // AND A
+        case 0xB7:          // OR A
+            if (!a_loaded)
+                return 0;
+            pc += 1;
+            break;
+        case 0xE6:          // AND n
+        case 0xFE:          // CP n
+            if (!a_loaded)
+                return 0;
+            pc += 2;
+            break;
+        case 0xCB:          // BIT b,A
+            opcode = read_memory(gb, pc + 1);
+            if (!a_loaded || opcode < 0x40 || opcode > 0x7F || (opcode & 0x07) != 0x07)
+                return 0;
+            pc += 2;
+            break;
+        default:
+            return 0;
+        }
+    }
+
+    if (pc != branch_pc)
+        return 0;
+
+    // The loop has to end with the jump back to the start
+    switch (read_memory(gb, branch_pc)) {
+    case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:     // JR (cc,)n
+    case 0xC3: case 0xC2: case 0xCA: case 0xD2: case 0xDA:     // JP (cc,)nn
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+void idle_loop_reset(GameBoy *gb) {
+    gb->idle_state = LOOP_NONE;
+}
+
+int idle_loop_check(GameBoy *gb, WORD branch_pc) {
+    WORD start = gb->PC;
+
+    if (gb->idle_state == LOOP_NONE || gb->idle_start != start || gb->idle_branch != branch_pc) {
+        // A different loop, or the first time round since the last event
+        gb->idle_start = start;
+        gb->idle_branch = branch_pc;
+        gb->idle_state = is_idle_loop(gb, start, branch_pc) ? LOOP_IDLE : LOOP_BUSY;
+        gb->idle_stamp = gb->total_cycles;
+        return gb->idle_state == LOOP_IDLE;
+    }
+
+    if (gb->idle_state != LOOP_IDLE)
+        return 0;
+
+    // One whole iteration has run since the last jump, skip as many more as fit before stop_cycle
+    unsigned long long iteration = gb->total_cycles - gb->idle_stamp;
+    if (iteration > 0 && gb->total_cycles < gb->stop_cycle) {
+        unsigned long long skipped = (gb->stop_cycle - gb->total_cycles) / iteration * iteration;
+        gb->total_cycles += skipped;
+        gb->idle_cycles_skipped += skipped;
+    }
+    gb->idle_stamp = gb->total_cycles;
+    return 1;
+}
@@ -0,0 +1,14 @@
+#ifndef IDLE_LOOP_H
+#define IDLE_LOOP_H
+#include "cpu.h"
+
+/* Forget the loop being watched. Called whenever an event may have run, since a serviced
+   interrupt breaks the one iteration between two branches that idle_loop_check() relies on */
+void idle_loop_reset(GameBoy *gb);
+
+/* Called after a jump from branch_pc to a lower address. If the jump closes a loop that only polls
+   memory which cannot change before the next event, whole iterations are skipped up to stop_cycle.
+   Returns 0 if the loop is not one, in which case the same jump does nothing until idle_loop_reset() */
+int idle_loop_check(GameBoy *gb, WORD branch_pc);
+
+#endif
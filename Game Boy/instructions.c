@@ -1,28 +1,29 @@
+#include "gameboy.h"
 #include "instructions.h"
 #include "display.h"
+#include "scheduler.h"
+#include "flags.h"
+#include "interrupts.h"
 
-void cpu_load(BYTE *reg) {
-    BYTE n = read_memory(PC++);
+void cpu_load(GameBoy *gb, BYTE *reg) {
+    BYTE n = read_memory(gb, gb->PC++);
     *reg = n;
 }
 
-void cpu_loadReg(BYTE *reg1, BYTE *reg2) {
-    *reg1 = *reg2;
-}
-
 void cpu_loadReg16(WORD *reg1, WORD *reg2) {
     *reg1 = *reg2;
 }
 
-void cpu_loadRegSP(BYTE *reg, Register *sp) {
-    *reg = sp->lo;
-    *(reg + 1) = sp->hi;
+void cpu_loadRegSP(GameBoy *gb, WORD address, Register *sp) {
+    write_memory(gb, address, sp->lo);
+    write_memory(gb, address + 1, sp->hi);
 }
 
-void LDHL_SP_n() {
-    SIGNED_BYTE s_n = (SIGNED_BYTE)read_memory(PC++);
+void LDHL_SP_n(GameBoy *gb) {
+    SIGNED_BYTE s_n = (SIGNED_BYTE)read_memory(gb, gb->PC++);
     BYTE u_n = (BYTE)s_n;
-    RegAF.lo = 0x00;
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     
     
   /*      // Set if there is a carry from bit 15
@@ -35,12 +36,12 @@ void LDHL_SP_n() {
             cpu_set_bit(FLAG_H, &RegAF.lo);
         }
         */
-        if (((BYTE)RegSP.data + u_n) > 0xFF) {
-            cpu_set_bit(FLAG_C, &RegAF.lo);  // Set if carry from bit 7
+        if (((BYTE)gb->RegSP.data + u_n) > 0xFF) {
+            cpu_set_bit(FLAG_C, &gb->RegAF.lo);  // Set if carry from bit 7
         }
 
-        if ((((BYTE)RegSP.data) & 0x0F) + (u_n & 0x0F) > 0xF) {
-            cpu_set_bit(FLAG_H, &RegAF.lo);  // Set if carry from bit 3
+        if ((((BYTE)gb->RegSP.data) & 0x0F) + (u_n & 0x0F) > 0xF) {
+            cpu_set_bit(FLAG_H, &gb->RegAF.lo);  // Set if carry from bit 3
         }
       //  WORD value = (RegSP.data + n) & 0xFFFF;
        // RegHL.data = value;
@@ -54,63 +55,73 @@ void LDHL_SP_n() {
          //       cpu_set_bit(FLAG_H,& RegAF.lo);
       //  if ((RegSP.data & 0xFFF) + (x & 0xFF) & 0xF000) {
       //  }
-       RegHL.data = (s_n + RegSP.data);
+       gb->RegHL.data = (s_n + gb->RegSP.data);
 }
 
-void stack_push(const BYTE *hi, const BYTE *lo) {
-    write_memory(--RegSP.data, *hi);
-    write_memory(--RegSP.data, *lo);
+void stack_push(GameBoy *gb, const BYTE *hi, const BYTE *lo) {
+    if (lo == &gb->RegAF.lo)
+        sync_flags(gb);
+    write_memory(gb, --gb->RegSP.data, *hi);
+    write_memory(gb, --gb->RegSP.data, *lo);
 }
 
-void stack_pop(BYTE *hi, BYTE *lo) {
-    if (lo == &RegAF.lo)
-        *lo = read_memory(RegSP.data++) & 0xF0;
+void stack_pop(GameBoy *gb, BYTE *hi, BYTE *lo) {
+    if (lo == &gb->RegAF.lo) {
+        discard_flags(gb);
+        *lo = read_memory(gb, gb->RegSP.data++) & 0xF0;
+    }
     else 
-        *lo = read_memory(RegSP.data++);
+        *lo = read_memory(gb, gb->RegSP.data++);
 
-    *hi = read_memory(RegSP.data++);
+    *hi = read_memory(gb, gb->RegSP.data++);
 }
 
-void cpu_add(BYTE *reg1, BYTE *reg2) {
-    RegAF.lo = 0x00;
+#if FLAG_MODE == FLAGS_EAGER
+void cpu_add(GameBoy *gb, BYTE n) {
+    gb->RegAF.lo = 0x00;
 
-    if ((*reg1 + *reg2) > 0xFF) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);  // Set if carry from bit 7
+    if ((gb->RegAF.hi + n) > 0xFF) {
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);  // Set if carry from bit 7
     }
 
-    if ((*reg1 & 0x0F) + (*reg2 & 0x0F) > 0x0F) {
-        cpu_set_bit(FLAG_H, &RegAF.lo);  // Set if carry from bit 3
+    if ((gb->RegAF.hi & 0x0F) + (n & 0x0F) > 0x0F) {
+        cpu_set_bit(FLAG_H, &gb->RegAF.lo);  // Set if carry from bit 3
     }
 
-    *reg1 += *reg2;
+    gb->RegAF.hi += n;
 
-    if (*reg1 == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+    if (gb->RegAF.hi == 0) {
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
+#endif
 
-void cpu_add16(WORD *reg1, WORD *reg2) {
-    RegAF.lo &= 0x80;
+void cpu_add16(GameBoy *gb, WORD *reg1, WORD *reg2) {
+    // Only the zero flag is kept
+    BYTE zero_flag = get_flag(gb, FLAG_Z);
+    discard_flags(gb);
+    gb->RegAF.lo = zero_flag << FLAG_Z;
 
     // Set if there is a carry from bit 15
     if ((*reg1 + *reg2) > 0xFFFF) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 
     // Set if there is a carry from bit 11
     if (((*reg1 & 0xFFF) + (*reg2 & 0xFFF)) > 0xFFF) {
-        cpu_set_bit(FLAG_H, &RegAF.lo);
+        cpu_set_bit(FLAG_H, &gb->RegAF.lo);
     }
 
     *reg1 += *reg2;
 
-    cpu_reset_bit(FLAG_N, &RegAF.lo);
+    cpu_reset_bit(FLAG_N, &gb->RegAF.lo);
 }
 
-void cpu_add_sp_n(void) {
-    SIGNED_BYTE s_n = (SIGNED_BYTE)read_memory(PC++);
+void cpu_add_sp_n(GameBoy *gb) {
+    SIGNED_BYTE s_n = (SIGNED_BYTE)read_memory(gb, gb->PC++);
     BYTE u_n = (BYTE)s_n;
-    RegAF.lo = 0x00;
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     /*
     if ((RegSP.data + *n) > 0xFF) {
         cpu_set_bit(FLAG_C, &RegAF.lo);  // Set if carry from bit 7
@@ -120,591 +131,623 @@ void cpu_add_sp_n(void) {
         cpu_set_bit(FLAG_H, &RegAF.lo);  // Set if carry from bit 3
     }
     */
-    if (((BYTE)RegSP.data + u_n) > 0xFF) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);  // Set if carry from bit 7
+    if (((BYTE)gb->RegSP.data + u_n) > 0xFF) {
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);  // Set if carry from bit 7
     }
 
-    if ((((BYTE)RegSP.data) & 0x0F) + (u_n & 0x0F) > 0xF) {
-        cpu_set_bit(FLAG_H, &RegAF.lo);  // Set if carry from bit 3
+    if ((((BYTE)gb->RegSP.data) & 0x0F) + (u_n & 0x0F) > 0xF) {
+        cpu_set_bit(FLAG_H, &gb->RegAF.lo);  // Set if carry from bit 3
     }
 
-    RegSP.data += s_n;
+    gb->RegSP.data += s_n;
 }
 
-void cpu_adc(BYTE *reg1, BYTE *reg2) {
-    BYTE carry_flag = (RegAF.lo & 0x10) >> FLAG_C;
-    RegAF.lo = 0x00;  
+#if FLAG_MODE == FLAGS_EAGER
+void cpu_adc(GameBoy *gb, BYTE n) {
+    BYTE carry_flag = (gb->RegAF.lo & 0x10) >> FLAG_C;
+    gb->RegAF.lo = 0x00;  
 
-    if ((*reg1 + *reg2 + carry_flag) > 0xFF) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);  // Set if carry from bit 7
+    if ((gb->RegAF.hi + n + carry_flag) > 0xFF) {
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);  // Set if carry from bit 7
     }
     
-    if ((*reg1 & 0x0F) + (*reg2 & 0x0F) + carry_flag > 0x0F) {
-        cpu_set_bit(FLAG_H, &RegAF.lo);  // Set if carry from bit 3
+    if ((gb->RegAF.hi & 0x0F) + (n & 0x0F) + carry_flag > 0x0F) {
+        cpu_set_bit(FLAG_H, &gb->RegAF.lo);  // Set if carry from bit 3
     }
 
-    *reg1 += *reg2;
-    *reg1 += carry_flag;
+    gb->RegAF.hi += n;
+    gb->RegAF.hi += carry_flag;
 
-    if (*reg1 == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+    if (gb->RegAF.hi == 0) {
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
-void cpu_sub(BYTE *reg1, BYTE *reg2) {
-    RegAF.lo = 0x00;
-    if ((*reg1 - *reg2) < 0) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);  // Set if borrow 
+void cpu_sub(GameBoy *gb, BYTE n) {
+    gb->RegAF.lo = 0x00;
+    if ((gb->RegAF.hi - n) < 0) {
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);  // Set if borrow 
     }
  
-    if ((*reg1 & 0x0F) - (*reg2 & 0x0F) < 0) {
-        cpu_set_bit(FLAG_H, &RegAF.lo);  // Set if borrow from bit 4
+    if ((gb->RegAF.hi & 0x0F) - (n & 0x0F) < 0) {
+        cpu_set_bit(FLAG_H, &gb->RegAF.lo);  // Set if borrow from bit 4
     }
 
-    *reg1 -= *reg2;
+    gb->RegAF.hi -= n;
 
-    if (*reg1 == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+    if (gb->RegAF.hi == 0) {
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 
-    cpu_set_bit(FLAG_N, &RegAF.lo);
+    cpu_set_bit(FLAG_N, &gb->RegAF.lo);
 }
 
-void cpu_sbc(BYTE *reg1, BYTE *reg2) {
-    BYTE carry_flag = (RegAF.lo & 0x10) >> FLAG_C;
-    RegAF.lo = 0x00;
+void cpu_sbc(GameBoy *gb, BYTE n) {
+    BYTE carry_flag = (gb->RegAF.lo & 0x10) >> FLAG_C;
+    gb->RegAF.lo = 0x00;
   
 
-    if ((*reg1 - *reg2 - carry_flag) < 0) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);  // Set if borrow
+    if ((gb->RegAF.hi - n - carry_flag) < 0) {
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);  // Set if borrow
     }
 
-    if (((*reg1 & 0x0F) - (*reg2 & 0x0F) - carry_flag) < 0) {
-        cpu_set_bit(FLAG_H, &RegAF.lo);  // Set if borrow from bit 4
+    if (((gb->RegAF.hi & 0x0F) - (n & 0x0F) - carry_flag) < 0) {
+        cpu_set_bit(FLAG_H, &gb->RegAF.lo);  // Set if borrow from bit 4
     }
 
-    *reg1 -= *reg2;
-    *reg1 -= carry_flag;
+    gb->RegAF.hi -= n;
+    gb->RegAF.hi -= carry_flag;
 
-    if (*reg1 == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+    if (gb->RegAF.hi == 0) {
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
-    cpu_set_bit(FLAG_N, &RegAF.lo);
+    cpu_set_bit(FLAG_N, &gb->RegAF.lo);
 
 }
 
-void cpu_and(BYTE *reg1, BYTE *reg2) {
-    RegAF.lo = 0x00;
-    *reg1 &= *reg2;
-    if (*reg1 == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+void cpu_and(GameBoy *gb, BYTE n) {
+    gb->RegAF.lo = 0x00;
+    gb->RegAF.hi &= n;
+    if (gb->RegAF.hi == 0) {
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
-    cpu_set_bit(FLAG_H, &RegAF.lo);
+    cpu_set_bit(FLAG_H, &gb->RegAF.lo);
 }
 
-void cpu_or(BYTE *reg1, BYTE *reg2) {
-    RegAF.lo = 0x00;
-    *reg1 |= *reg2;
-    if (*reg1 == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+void cpu_or(GameBoy *gb, BYTE n) {
+    gb->RegAF.lo = 0x00;
+    gb->RegAF.hi |= n;
+    if (gb->RegAF.hi == 0) {
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
-void cpu_xor(BYTE *reg1, BYTE *reg2) {
-    RegAF.lo = 0x00;
-    *reg1 ^= *reg2;
-    if (*reg1 == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+void cpu_xor(GameBoy *gb, BYTE n) {
+    gb->RegAF.lo = 0x00;
+    gb->RegAF.hi ^= n;
+    if (gb->RegAF.hi == 0) {
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
-void cpu_cp(BYTE *reg) {
-    RegAF.lo = 0x00;
-    BYTE result = RegAF.hi - *reg;
+void cpu_cp(GameBoy *gb, BYTE n) {
+    gb->RegAF.lo = 0x00;
+    BYTE result = gb->RegAF.hi - n;
     if (result == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
     
-    if ((RegAF.hi) < (*reg)) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+    if (gb->RegAF.hi < n) {
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
     
-    if ((RegAF.hi & 0x0F) < (*reg & 0x0F)) {
-        cpu_set_bit(FLAG_H, &RegAF.lo);
+    if ((gb->RegAF.hi & 0x0F) < (n & 0x0F)) {
+        cpu_set_bit(FLAG_H, &gb->RegAF.lo);
     }
 
-    cpu_set_bit(FLAG_N, &RegAF.lo);
+    cpu_set_bit(FLAG_N, &gb->RegAF.lo);
 }
 
-void cpu_inc(BYTE *reg) {
-    RegAF.lo &= 1 << FLAG_C;
+BYTE cpu_inc(GameBoy *gb, BYTE n) {
+    gb->RegAF.lo &= 1 << FLAG_C;
     
-    if ((*reg & 0x0F) == 0x0F) {
-        cpu_set_bit(FLAG_H, &RegAF.lo);
+    if ((n & 0x0F) == 0x0F) {
+        cpu_set_bit(FLAG_H, &gb->RegAF.lo);
     }
 
-    *reg += 1;
+    n += 1;
 
-    if (*reg == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+    if (n == 0) {
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
-
+    return n;
 }
 
-void cpu_inc_hl(WORD address) {
-    BYTE data = read_memory(address);
-    RegAF.lo &= 1 << FLAG_C;
+void cpu_inc_hl(GameBoy *gb, WORD address) {
+    BYTE data = read_memory(gb, address);
+    gb->RegAF.lo &= 1 << FLAG_C;
 
     if ((data & 0x0F) == 0x0F) {
-        cpu_set_bit(FLAG_H, &RegAF.lo);
+        cpu_set_bit(FLAG_H, &gb->RegAF.lo);
     }
 
     data += 1;
-    write_memory(address, data);
+    write_memory(gb, address, data);
 
     if (data == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 
 }
+#endif
 
 void cpu_inc16(WORD *reg) {
     *reg += 1;
 }
 
-void cpu_dec(BYTE *reg) {
-    RegAF.lo &= (1 << FLAG_C);
+#if FLAG_MODE == FLAGS_EAGER
+BYTE cpu_dec(GameBoy *gb, BYTE n) {
+    gb->RegAF.lo &= (1 << FLAG_C);
 
-    if ((*reg & 0x0F) == 0) {
-        cpu_set_bit(FLAG_H, &RegAF.lo);
+    if ((n & 0x0F) == 0) {
+        cpu_set_bit(FLAG_H, &gb->RegAF.lo);
     }
 
-    *reg -= 1;
+    n -= 1;
 
-    if (*reg == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+    if (n == 0) {
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 
-    cpu_set_bit(FLAG_N, &RegAF.lo);
+    cpu_set_bit(FLAG_N, &gb->RegAF.lo);
+    return n;
 }
 
-void cpu_dec_hl(WORD address) {
-    BYTE data = read_memory(address);
-    RegAF.lo &= (1 << FLAG_C);
+void cpu_dec_hl(GameBoy *gb, WORD address) {
+    BYTE data = read_memory(gb, address);
+    gb->RegAF.lo &= (1 << FLAG_C);
 
     if ((data & 0x0F) == 0) {
-        cpu_set_bit(FLAG_H, &RegAF.lo);
+        cpu_set_bit(FLAG_H, &gb->RegAF.lo);
     }
 
     data -= 1;
-    write_memory(address, data);
+    write_memory(gb, address, data);
 
     if (data == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 
-    cpu_set_bit(FLAG_N, &RegAF.lo);
+    cpu_set_bit(FLAG_N, &gb->RegAF.lo);
 }
+#endif
 
 void cpu_dec16(WORD *reg) {
     *reg -= 1;
 }
 
-void cpu_swap(BYTE *reg) {
-    RegAF.lo = 0x00;
+void cpu_swap(GameBoy *gb, BYTE *reg) {
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     BYTE upper_nibble = (*reg & 0x0F) << 4;
     BYTE lower_nibble = (*reg & 0xF0) >> 4;
     *reg = upper_nibble | lower_nibble;
     if (*reg == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
-void cpu_swap_hl(WORD address) {
-    BYTE data = read_memory(address);
-    RegAF.lo = 0x00;
+void cpu_swap_hl(GameBoy *gb, WORD address) {
+    BYTE data = read_memory(gb, address);
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     BYTE upper_nibble = (data & 0x0F) << 4;
     BYTE lower_nibble = (data & 0xF0) >> 4;
     data = upper_nibble | lower_nibble;
-    write_memory(address, data);
+    write_memory(gb, address, data);
     if (data == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
-void cpu_daa() {
+#if FLAG_MODE != FLAGS_TABLE
+void cpu_daa(GameBoy *gb) {
+    sync_flags(gb);
     BYTE n = 0x00;
 
     // Previous instruction was addition
-    if (!test_bit(FLAG_N, &RegAF.lo)) {
-        if (RegAF.hi > 0x99 || test_bit(FLAG_C, &RegAF.lo)) {
-            cpu_set_bit(FLAG_C, &RegAF.lo);
+    if (!test_bit(FLAG_N, &gb->RegAF.lo)) {
+        if (gb->RegAF.hi > 0x99 || test_bit(FLAG_C, &gb->RegAF.lo)) {
+            cpu_set_bit(FLAG_C, &gb->RegAF.lo);
             n |= 0x60;
         }
-        if (((RegAF.hi & 0x0F) > 0x09) || test_bit(FLAG_H, &RegAF.lo)) {
+        if (((gb->RegAF.hi & 0x0F) > 0x09) || test_bit(FLAG_H, &gb->RegAF.lo)) {
             n |= 0x06;
         }
     }
     // Previous instruction was subtraction
     else{
-        if (test_bit(FLAG_C, &RegAF.lo)) {
-            cpu_set_bit(FLAG_C, &RegAF.lo);
+        if (test_bit(FLAG_C, &gb->RegAF.lo)) {
+            cpu_set_bit(FLAG_C, &gb->RegAF.lo);
             
-            if (!test_bit(FLAG_H, &RegAF.lo))
+            if (!test_bit(FLAG_H, &gb->RegAF.lo))
                 n |= 0xA0;
         }
-        if (test_bit(FLAG_H, &RegAF.lo)) {
+        if (test_bit(FLAG_H, &gb->RegAF.lo)) {
             n |= 0x0A;
 
-            if (test_bit(FLAG_C, &RegAF.lo))
+            if (test_bit(FLAG_C, &gb->RegAF.lo))
                 n |= 0x90;
             else
                 n |= 0xF0;
         }
     }
 
-    RegAF.hi += n;
+    gb->RegAF.hi += n;
 
-    if (RegAF.hi == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+    if (gb->RegAF.hi == 0) {
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
     else {
-        cpu_reset_bit(FLAG_Z, &RegAF.lo);
+        cpu_reset_bit(FLAG_Z, &gb->RegAF.lo);
     }
-    cpu_reset_bit(FLAG_H, &RegAF.lo);
+    cpu_reset_bit(FLAG_H, &gb->RegAF.lo);
 }
+#endif
 
-void cpu_cpl() {
-    RegAF.hi ^= 0xFF;
-    cpu_set_bit(FLAG_N, &RegAF.lo);
-    cpu_set_bit(FLAG_H, &RegAF.lo);
+void cpu_cpl(GameBoy *gb) {
+    sync_flags(gb);
+    gb->RegAF.hi ^= 0xFF;
+    cpu_set_bit(FLAG_N, &gb->RegAF.lo);
+    cpu_set_bit(FLAG_H, &gb->RegAF.lo);
 }
 
-void cpu_ccf() {
-    RegAF.lo ^= (1 << FLAG_C);
-    cpu_reset_bit(FLAG_N, &RegAF.lo);
-    cpu_reset_bit(FLAG_H, &RegAF.lo);
+void cpu_ccf(GameBoy *gb) {
+    sync_flags(gb);
+    gb->RegAF.lo ^= (1 << FLAG_C);
+    cpu_reset_bit(FLAG_N, &gb->RegAF.lo);
+    cpu_reset_bit(FLAG_H, &gb->RegAF.lo);
 }
 
-void cpu_scf() {
-    cpu_set_bit(FLAG_C, &RegAF.lo);
-    cpu_reset_bit(FLAG_N, &RegAF.lo);
-    cpu_reset_bit(FLAG_H, &RegAF.lo);
+void cpu_scf(GameBoy *gb) {
+    sync_flags(gb);
+    cpu_set_bit(FLAG_C, &gb->RegAF.lo);
+    cpu_reset_bit(FLAG_N, &gb->RegAF.lo);
+    cpu_reset_bit(FLAG_H, &gb->RegAF.lo);
 }
 
-void cpu_halt() {
-    set_halt();
+void cpu_halt(GameBoy *gb) {
+    set_halt(gb);
 }
 
-void cpu_stop() {
+void cpu_stop(GameBoy *gb) {
 }
 
-void cpu_ei(int enable) {
+void cpu_ei(GameBoy *gb, int enable) {
     if (enable == 0) {
-        IME = 0;
+        gb->IME = 0;
     }
     else {
-        IME = 1;
+        gb->IME = 1;
+        update_interrupts(gb);
     }
 }
 
-void cpu_rlca(void) {
-    RegAF.lo = 0x00;
-    BYTE bit = (RegAF.hi & 0x80) >> 7; // Save most significant bit
-    RegAF.hi <<= 1;
-    RegAF.hi |= bit;
+void cpu_rlca(GameBoy *gb) {
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
+    BYTE bit = (gb->RegAF.hi & 0x80) >> 7; // Save most significant bit
+    gb->RegAF.hi <<= 1;
+    gb->RegAF.hi |= bit;
 
     if (bit == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 }
 
-void cpu_rla(void) {
-    BYTE cy = test_bit(FLAG_C, &RegAF.lo);  // Save carry flag
-    RegAF.lo = 0x00;
+void cpu_rla(GameBoy *gb) {
+    BYTE cy = get_flag(gb, FLAG_C);  // Save carry flag
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     
-    BYTE msb = test_bit(7, &RegAF.hi); // Save most significant bit
-    RegAF.hi <<= 1;
-    RegAF.hi |= cy;
+    BYTE msb = test_bit(7, &gb->RegAF.hi); // Save most significant bit
+    gb->RegAF.hi <<= 1;
+    gb->RegAF.hi |= cy;
     
     // The value of the carry flag is set to the LSB of the register
     if (cy) {
-      cpu_set_bit(0, &RegAF.hi);
+      cpu_set_bit(0, &gb->RegAF.hi);
     }
     
     // The value of the RegA msb is set to the carry flag
     if (msb) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 }
 
-void cpu_rrca(void) {
-    RegAF.lo = 0x00;
-    BYTE bit = RegAF.hi & 0x01; // Save least significant bit
-    RegAF.hi >>= 1;
-    RegAF.hi |= (bit << 7);
+void cpu_rrca(GameBoy *gb) {
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
+    BYTE bit = gb->RegAF.hi & 0x01; // Save least significant bit
+    gb->RegAF.hi >>= 1;
+    gb->RegAF.hi |= (bit << 7);
 
     if (bit == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 }
 
-void cpu_rra(void) {
-    BYTE carry_flag = (RegAF.lo & 0x10) >> FLAG_C; // Save carry flag
-    RegAF.lo = 0x00;
-    BYTE bit = RegAF.hi & 0x01; // Save least significant bit
-    RegAF.hi >>= 1;
-    RegAF.hi |= (carry_flag << 7); // The value of the carry flag is set to the MSB of the register
+void cpu_rra(GameBoy *gb) {
+    BYTE carry_flag = get_flag(gb, FLAG_C); // Save carry flag
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
+    BYTE bit = gb->RegAF.hi & 0x01; // Save least significant bit
+    gb->RegAF.hi >>= 1;
+    gb->RegAF.hi |= (carry_flag << 7); // The value of the carry flag is set to the MSB of the register
 
     if (bit == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 }
 
 
-void cpu_rlc(BYTE *reg) {
-    RegAF.lo = 0x00;
+void cpu_rlc(GameBoy *gb, BYTE *reg) {
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     BYTE bit = (*reg & 0x80) >> 7; // Save most significant bit
     *reg <<= 1;
     *reg |= bit;
 
     if (bit == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 
     if (*reg == 0)
     {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
-void cpu_rlc_hl(WORD address) {
-    BYTE data = read_memory(address);
-    RegAF.lo = 0x00;
+void cpu_rlc_hl(GameBoy *gb, WORD address) {
+    BYTE data = read_memory(gb, address);
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     BYTE bit = (data & 0x80) >> 7; // Save most significant bit
     data <<= 1;
     data |= bit;
-    write_memory(address, data);
+    write_memory(gb, address, data);
 
     if (bit == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 
     if (data == 0)
     {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
-void cpu_rl(BYTE *reg) {
+void cpu_rl(GameBoy *gb, BYTE *reg) {
     //BYTE carry_flag = (RegAF.lo & 0x10) >> FLAG_C;  // Save carry flag
-    BYTE carry_flag = test_bit(FLAG_C, &RegAF.lo);
-    RegAF.lo = 0x00;
+    BYTE carry_flag = get_flag(gb, FLAG_C);
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     BYTE bit = (*reg & 0x80) >> 7; // Save most significant bit
     *reg <<= 1;
     *reg |= carry_flag; // The value of the carry flag is set to the LSB of the register
 
     if (bit == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 
     if (*reg == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
-void cpu_rl_hl(WORD address) {
-    BYTE data = read_memory(address);
-    BYTE carry_flag = test_bit(FLAG_C, &RegAF.lo);
-    RegAF.lo = 0x00;
+void cpu_rl_hl(GameBoy *gb, WORD address) {
+    BYTE data = read_memory(gb, address);
+    BYTE carry_flag = get_flag(gb, FLAG_C);
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     BYTE bit = (data & 0x80) >> 7; // Save most significant bit
     data <<= 1;
     data |= carry_flag; // The value of the carry flag is set to the LSB of the register
-    write_memory(address, data);
+    write_memory(gb, address, data);
 
     if (bit == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 
     if (data == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
-void cpu_rrc(BYTE *reg) {
-    RegAF.lo = 0x00;
+void cpu_rrc(GameBoy *gb, BYTE *reg) {
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     BYTE bit = *reg & 0x01; // Save least significant bit
     *reg >>= 1;
     *reg |= (bit << 7);
 
     if (bit == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 
     if (*reg == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
-void cpu_rrc_hl(WORD address) {
-    BYTE data = read_memory(address);
-    RegAF.lo = 0x00;
+void cpu_rrc_hl(GameBoy *gb, WORD address) {
+    BYTE data = read_memory(gb, address);
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     BYTE bit = data & 0x01; // Save least significant bit
     data >>= 1;
     data |= (bit << 7);
-    write_memory(address, data);
+    write_memory(gb, address, data);
 
     if (bit == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 
     if (data == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
-void cpu_rr(BYTE *reg) {
-    BYTE carry_flag = test_bit(FLAG_C, &RegAF.lo); // Save carry flag
-    RegAF.lo = 0x00; 
+void cpu_rr(GameBoy *gb, BYTE *reg) {
+    BYTE carry_flag = get_flag(gb, FLAG_C); // Save carry flag
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00; 
     BYTE bit = *reg & 0x01; // Save least significant bit
     *reg >>= 1;
     *reg |= (carry_flag << 7); // The value of the carry flag is set to the MSB of the register
 
     if (bit == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 
     if (*reg == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
-void cpu_rr_hl(WORD address) {
-    BYTE data = read_memory(address);
-    BYTE carry_flag = test_bit(FLAG_C, &RegAF.lo); // Save carry flag
-    RegAF.lo = 0x00;
+void cpu_rr_hl(GameBoy *gb, WORD address) {
+    BYTE data = read_memory(gb, address);
+    BYTE carry_flag = get_flag(gb, FLAG_C); // Save carry flag
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     BYTE bit = data & 0x01; // Save least significant bit
     data >>= 1;
     data |= (carry_flag << 7); // The value of the carry flag is set to the MSB of the register
-    write_memory(address, data);
+    write_memory(gb, address, data);
 
     if (bit == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 
     if (data == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
 
-void cpu_sla(BYTE *reg) {
-    RegAF.lo = 0x00;
+void cpu_sla(GameBoy *gb, BYTE *reg) {
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     BYTE bit = (*reg & 0x80) >> 7; // Save most significant bit
     *reg <<= 1;
 
     if (bit == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 
     if (*reg == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
-void cpu_sla_hl(WORD address) {
-    BYTE data = read_memory(address);
-    RegAF.lo = 0x00;
+void cpu_sla_hl(GameBoy *gb, WORD address) {
+    BYTE data = read_memory(gb, address);
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     BYTE bit = (data & 0x80) >> 7; // Save most significant bit
     data <<= 1;
-    write_memory(address, data);
+    write_memory(gb, address, data);
 
     if (bit == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 
     if (data == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
 
-void cpu_sra(BYTE *reg) {
-    RegAF.lo = 0x00;
+void cpu_sra(GameBoy *gb, BYTE *reg) {
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     BYTE lsb = *reg & 0x01; // Save least significant bit
     BYTE msb = *reg & 0x80; // Save most significant bit
     *reg >>= 1;
     *reg |= msb;
 
     if (lsb == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 
     if (*reg == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
-void cpu_sra_hl(WORD address) {
-    BYTE data = read_memory(address);
-    RegAF.lo = 0x00;
+void cpu_sra_hl(GameBoy *gb, WORD address) {
+    BYTE data = read_memory(gb, address);
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     BYTE lsb = data & 0x01; // Save least significant bit
     BYTE msb = data & 0x80; // Save most significant bit
     data >>= 1;
     data |= msb;
-    write_memory(address, data);
+    write_memory(gb, address, data);
 
     if (lsb == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 
     if (data == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
 
-void cpu_srl(BYTE *reg) {
-    RegAF.lo = 0x00;
+void cpu_srl(GameBoy *gb, BYTE *reg) {
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     BYTE bit = *reg & 0x01; // Save least significant bit
     *reg >>= 1;
 
     if (bit == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 
     if (*reg == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
-void cpu_srl_hl(WORD address) {
-    BYTE data = read_memory(address);
-    RegAF.lo = 0x00;
+void cpu_srl_hl(GameBoy *gb, WORD address) {
+    BYTE data = read_memory(gb, address);
+    discard_flags(gb);
+    gb->RegAF.lo = 0x00;
     BYTE bit = data & 0x01; // Save least significant bit
     data >>= 1;
-    write_memory(address, data);
+    write_memory(gb, address, data);
 
     if (bit == 1) {
-        cpu_set_bit(FLAG_C, &RegAF.lo);
+        cpu_set_bit(FLAG_C, &gb->RegAF.lo);
     }
 
     if (data == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
 }
 
-void cpu_test_bit(BYTE b, BYTE *reg) {
+void cpu_test_bit(GameBoy *gb, BYTE b, BYTE *reg) {
+    // Only the carry flag is kept, so lazy flags are not worked out in full
+    BYTE carry_flag = get_flag(gb, FLAG_C);
+    discard_flags(gb);
+    gb->RegAF.lo = carry_flag << FLAG_C;
     BYTE test_bit = 1 << b;
     if ((*reg & test_bit) == 0) {
-        cpu_set_bit(FLAG_Z, &RegAF.lo);
-    }
-    else {
-        cpu_reset_bit(FLAG_Z, &RegAF.lo);
+        cpu_set_bit(FLAG_Z, &gb->RegAF.lo);
     }
-    
-    cpu_reset_bit(FLAG_N, &RegAF.lo); 
-    cpu_set_bit(FLAG_H, &RegAF.lo);
+
+    cpu_set_bit(FLAG_H, &gb->RegAF.lo);
 }
 
 void cpu_set_bit(BYTE b, BYTE *reg) {
@@ -712,11 +755,11 @@ void cpu_set_bit(BYTE b, BYTE *reg) {
     *reg |= set_bit;
 }
 
-void cpu_set_bit_hl(BYTE b, WORD address) {
-    BYTE data = read_memory(address);
+void cpu_set_bit_hl(GameBoy *gb, BYTE b, WORD address) {
+    BYTE data = read_memory(gb, address);
     BYTE set_bit = 1 << b;
     data |= set_bit;
-    write_memory(address, data);
+    write_memory(gb, address, data);
 }
 
 void cpu_reset_bit(BYTE b, BYTE *reg) {
@@ -724,69 +767,69 @@ void cpu_reset_bit(BYTE b, BYTE *reg) {
     *reg &= ~reset_bit;
 }
 
-void cpu_reset_bit_hl(BYTE b, WORD address) {
-    BYTE data = read_memory(address);
+void cpu_reset_bit_hl(GameBoy *gb, BYTE b, WORD address) {
+    BYTE data = read_memory(gb, address);
     BYTE reset_bit = 1 << b;
     data &= ~reset_bit;
-    write_memory(address, data);
+    write_memory(gb, address, data);
 }
 
-void cpu_jump(CONDITION cond) {
+void cpu_jump(GameBoy *gb, CONDITION cond) {
     WORD nn = 0x0000;
-    BYTE n = read_memory(PC++);
+    BYTE n = read_memory(gb, gb->PC++);
     nn = n;
-    nn |= read_memory(PC++) << 8;
+    nn |= read_memory(gb, gb->PC++) << 8;
     switch (cond)
     {
     case NONE:
-        PC = nn;
+        gb->PC = nn;
         break;
-    case NZ: if (test_bit(FLAG_Z, &RegAF.lo) == 0) {   // Jump if Z flag is reset
-        PC = nn;
+    case NZ: if (get_flag(gb, FLAG_Z) == 0) {   // Jump if Z flag is reset
+        gb->PC = nn;
     }
         break;
     case Z:  
-        if (test_bit(FLAG_Z, &RegAF.lo)) {     // Jump if Z flag is set 
-        PC = nn;
+        if (get_flag(gb, FLAG_Z)) {     // Jump if Z flag is set 
+        gb->PC = nn;
         }
         break;
-    case NC: if (test_bit(FLAG_C, &RegAF.lo) == 0) {   // Jump if C flag is reset
-        PC = nn;
+    case NC: if (get_flag(gb, FLAG_C) == 0) {   // Jump if C flag is reset
+        gb->PC = nn;
     }
         break;
-    case C:  if (test_bit(FLAG_C, &RegAF.lo)) {     // Jump if C flag is set
-        PC = nn;
+    case C:  if (get_flag(gb, FLAG_C)) {     // Jump if C flag is set
+        gb->PC = nn;
     }
         break;
     case HL:                // Jump to the address contained in HL
-        PC = RegHL.data;
+        gb->PC = gb->RegHL.data;
         break;
     default:
         break;
     }
 }
 
-void cpu_jr(CONDITION cond) {
-    SIGNED_BYTE n = (SIGNED_BYTE)read_memory(PC++);
+void cpu_jr(GameBoy *gb, CONDITION cond) {
+    SIGNED_BYTE n = (SIGNED_BYTE)read_memory(gb, gb->PC++);
     switch (cond)
     {
     case NONE:
-        PC += n;
+        gb->PC += n;
         break;
-    case NZ: if (test_bit(FLAG_Z, &RegAF.lo) == 0) {    // Jump if Z flag is reset
-        PC += n;
+    case NZ: if (get_flag(gb, FLAG_Z) == 0) {    // Jump if Z flag is reset
+        gb->PC += n;
     }
         break;
-    case Z:  if (test_bit(FLAG_Z, &RegAF.lo)) {     // Jump if Z flag is set 
-        PC += n;
+    case Z:  if (get_flag(gb, FLAG_Z)) {     // Jump if Z flag is set 
+        gb->PC += n;
     }
         break;
-    case NC: if (test_bit(FLAG_C, &RegAF.lo) == 0) {   // Jump if C flag is reset
-        PC += n;
+    case NC: if (get_flag(gb, FLAG_C) == 0) {   // Jump if C flag is reset
+        gb->PC += n;
     }
         break;
-    case C:  if (test_bit(FLAG_C, &RegAF.lo)) {    // Jump if C flag is set
-        PC += n;
+    case C:  if (get_flag(gb, FLAG_C)) {    // Jump if C flag is set
+        gb->PC += n;
     }
         break;
     default:
@@ -794,38 +837,38 @@ void cpu_jr(CONDITION cond) {
     }
 }
 
-void cpu_call(CONDITION cond) {
+void cpu_call(GameBoy *gb, CONDITION cond) {
     WORD nn = 0x0000;
-    BYTE n = read_memory(PC++);
+    BYTE n = read_memory(gb, gb->PC++);
     nn = n;
-    nn |= (read_memory(PC++) << 8);
-    BYTE pc_hi = ((PC & 0xFF00) >> 8);
-    BYTE pc_lo = (PC & 0xFF);
+    nn |= (read_memory(gb, gb->PC++) << 8);
+    BYTE pc_hi = ((gb->PC & 0xFF00) >> 8);
+    BYTE pc_lo = (gb->PC & 0xFF);
     switch (cond)
     {
     case NONE:
-        stack_push(&pc_hi, &pc_lo);
-        PC = nn;
+        stack_push(gb, &pc_hi, &pc_lo);
+        gb->PC = nn;
         break;
     case NZ:
-        if (test_bit(FLAG_Z, &RegAF.lo) == 0) {    // Jump if Z flag is reset
-            stack_push(&pc_hi, &pc_lo);
-            PC = nn;
+        if (get_flag(gb, FLAG_Z) == 0) {    // Jump if Z flag is reset
+            stack_push(gb, &pc_hi, &pc_lo);
+            gb->PC = nn;
         }
         break;
-    case Z: if (test_bit(FLAG_Z, &RegAF.lo)) {     // Jump if Z flag is set 
-        stack_push(&pc_hi, &pc_lo);
-        PC = nn;
+    case Z: if (get_flag(gb, FLAG_Z)) {     // Jump if Z flag is set 
+        stack_push(gb, &pc_hi, &pc_lo);
+        gb->PC = nn;
     }
        break;
-   case NC: if (test_bit(FLAG_C, &RegAF.lo) == 0) {    // Jump if C flag is reset
-       stack_push(&pc_hi, &pc_lo);
-       PC = nn;
+   case NC: if (get_flag(gb, FLAG_C) == 0) {    // Jump if C flag is reset
+       stack_push(gb, &pc_hi, &pc_lo);
+       gb->PC = nn;
    }
        break;
-   case C:  if (test_bit(FLAG_C, &RegAF.lo)) {     // Jump if C flag is set
-       stack_push(&pc_hi, &pc_lo);
-       PC = nn;
+   case C:  if (get_flag(gb, FLAG_C)) {     // Jump if C flag is set
+       stack_push(gb, &pc_hi, &pc_lo);
+       gb->PC = nn;
    }
        break;
     default:
@@ -833,52 +876,52 @@ void cpu_call(CONDITION cond) {
     }
 }
 
-void cpu_rst(BYTE n) {
-    BYTE hi = (PC & 0xFF00) >> 8;
-    BYTE lo = (PC & 0x00FF);
-    stack_push(&hi, &lo);
-    PC = n;
+void cpu_rst(GameBoy *gb, BYTE n) {
+    BYTE hi = (gb->PC & 0xFF00) >> 8;
+    BYTE lo = (gb->PC & 0x00FF);
+    stack_push(gb, &hi, &lo);
+    gb->PC = n;
 }
 
-void cpu_ret(CONDITION cond) {
+void cpu_ret(GameBoy *gb, CONDITION cond) {
     BYTE lo = 0x00;
     BYTE hi = 0x00;
     WORD nn = 0x0000;
     switch (cond)
     {
     case NONE:
-        stack_pop(&hi, &lo);
+        stack_pop(gb, &hi, &lo);
         nn = hi << 8;
         nn |= lo;
-        PC = nn;
+        gb->PC = nn;
         break;
         
-    case NZ: if (test_bit(FLAG_Z, &RegAF.lo) == 0) {    // Jump if Z flag is reset
-        stack_pop(&hi, &lo);
+    case NZ: if (get_flag(gb, FLAG_Z) == 0) {    // Jump if Z flag is reset
+        stack_pop(gb, &hi, &lo);
         nn = hi << 8;
         nn |= lo;
-        PC = nn;
+        gb->PC = nn;
     }
         break;
-    case Z: if (test_bit(FLAG_Z, &RegAF.lo)) {     // Jump if Z flag is set 
-        stack_pop(&hi, &lo);
+    case Z: if (get_flag(gb, FLAG_Z)) {     // Jump if Z flag is set 
+        stack_pop(gb, &hi, &lo);
         nn = hi << 8;
         nn |= lo;
-        PC = nn;
+        gb->PC = nn;
     }
        break;
-   case NC: if (test_bit(FLAG_C, &RegAF.lo) == 0) {    // Jump if C flag is reset
-       stack_pop(&hi, &lo);
+   case NC: if (get_flag(gb, FLAG_C) == 0) {    // Jump if C flag is reset
+       stack_pop(gb, &hi, &lo);
        nn = hi << 8;
        nn |= lo;
-       PC = nn;
+       gb->PC = nn;
    }
        break;
-   case C: if (test_bit(FLAG_C, &RegAF.lo)) {     // Jump if C flag is set
-       stack_pop(&hi, &lo);
+   case C: if (get_flag(gb, FLAG_C)) {     // Jump if C flag is set
+       stack_pop(gb, &hi, &lo);
        nn = hi << 8;
        nn |= lo;
-       PC = nn;
+       gb->PC = nn;
    }
       break;
     default:
@@ -886,14 +929,14 @@ void cpu_ret(CONDITION cond) {
     }
 }
 
-void cpu_reti() {
+void cpu_reti(GameBoy *gb) {
     BYTE lo;
     BYTE hi;
-    stack_pop(&hi, &lo);
+    stack_pop(gb, &hi, &lo);
     WORD nn = (hi << 8);
     nn |= lo;
-    PC = nn;
-    cpu_ei(1);
+    gb->PC = nn;
+    cpu_ei(gb, 1);
 }
 
 int test_bit(BYTE b, BYTE *reg) {
@@ -3,173 +3,173 @@
 #include "cpu.h"
 
 /* Put value r2 into r1 */
-void cpu_load(BYTE *reg);
+void cpu_load(GameBoy *gb, BYTE *reg);
 
 // ADD descrp
-void cpu_loadRegSP(BYTE *reg, Register *sp);
+void cpu_loadRegSP(GameBoy *gb, WORD address, Register *sp);
 
 // ADD descrp
-void LDHL_SP_n();
+void LDHL_SP_n(GameBoy *gb);
 
 /* Add n to A */
-void cpu_add(BYTE *reg1, BYTE *reg2);
+void cpu_add(GameBoy *gb, BYTE n);
 
 /* 16-Bit add instruction */
-void cpu_add16(WORD *reg1, WORD *reg2);
+void cpu_add16(GameBoy *gb, WORD *reg1, WORD *reg2);
 
 /* Add n + carry flag to A */
-void cpu_adc(BYTE *reg1, BYTE *reg2);
+void cpu_adc(GameBoy *gb, BYTE n);
 
 /* Add the contents of the 8-bit immediate operand to register SP */
-void cpu_add_sp_n(void);
+void cpu_add_sp_n(GameBoy *gb);
 
 /* Subtract n from A */
-void cpu_sub(BYTE *reg1, BYTE *reg2);
+void cpu_sub(GameBoy *gb, BYTE n);
 
 /* Subtract n + carry flag from A */
-void cpu_sbc(BYTE *reg1, BYTE *reg2);
+void cpu_sbc(GameBoy *gb, BYTE n);
 
 /* Test bit b in register r */
-void cpu_test_bit(BYTE b, BYTE *reg);
+void cpu_test_bit(GameBoy *gb, BYTE b, BYTE *reg);
 
 /* Set bit b in register r */
 void cpu_set_bit(BYTE b, BYTE *reg);
 
-void cpu_set_bit_hl(BYTE b, WORD address);
+void cpu_set_bit_hl(GameBoy *gb, BYTE b, WORD address);
 
 /* Reset bit b in register r */
 void cpu_reset_bit(BYTE b, BYTE *reg);
 
-void cpu_reset_bit_hl(BYTE b, WORD address);
+void cpu_reset_bit_hl(GameBoy *gb, BYTE b, WORD address);
 
 
 void cpu_loadReg16(WORD *reg1, WORD *reg2);
 
 /* Logical AND n with A */
-void cpu_and(BYTE *reg1, BYTE *reg2);
+void cpu_and(GameBoy *gb, BYTE n);
 
 /* Logical OR n with register A */
-void cpu_or(BYTE *reg1, BYTE *reg2);
+void cpu_or(GameBoy *gb, BYTE n);
 
 /* Logical exclusive OR n with register */
-void cpu_xor(BYTE *reg1, BYTE *reg2);
+void cpu_xor(GameBoy *gb, BYTE n);
 
 /* Compare register A with n */
-void cpu_cp(BYTE *reg);
+void cpu_cp(GameBoy *gb, BYTE n);
 
-/* Increment 8-bit register */
-void cpu_inc(BYTE *reg);
+/* Returns n + 1, setting the flags for INC */
+BYTE cpu_inc(GameBoy *gb, BYTE n);
 
 /* Jump to the address of the immediate two byte value if the condition is true  */
-void cpu_jump(CONDITION cond);
+void cpu_jump(GameBoy *gb, CONDITION cond);
 
 /* Add the immediate signed byte value to the current address and jump if the condition is true */
-void cpu_jr(CONDITION cond);
+void cpu_jr(GameBoy *gb, CONDITION cond);
 
 /* Push address of the next instruction onto stack and then jump to address nn if the condition is true */
-void cpu_call(CONDITION cond);
+void cpu_call(GameBoy *gb, CONDITION cond);
 
 /* Push current address onto stack and jump to address 0x00 + n */
-void cpu_rst(BYTE n);
+void cpu_rst(GameBoy *gb, BYTE n);
 
 /* Pop two bytes from stack and jump to that address */
-void cpu_ret(CONDITION cond);
+void cpu_ret(GameBoy *gb, CONDITION cond);
 
 /* Pop two bytes from stack and jump to that address then enable interrupts */
-void cpu_reti(void);
+void cpu_reti(GameBoy *gb);
 
-void cpu_inc_hl(WORD address);
+void cpu_inc_hl(GameBoy *gb, WORD address);
 
 /* Increment 16-bit register  */
 void cpu_inc16(WORD *reg);
 
-/* Decrement 8-bit register */
-void cpu_dec(BYTE *reg);
+/* Returns n - 1, setting the flags for DEC */
+BYTE cpu_dec(GameBoy *gb, BYTE n);
 
-void cpu_dec_hl(WORD address);
+void cpu_dec_hl(GameBoy *gb, WORD address);
 
 /* Decrement 16-bit register */
 void cpu_dec16(WORD *reg);
 
 /* Swap upper & lower nibbles of n */
-void cpu_swap(BYTE *reg);
+void cpu_swap(GameBoy *gb, BYTE *reg);
 
-void cpu_swap_hl(WORD address);
+void cpu_swap_hl(GameBoy *gb, WORD address);
 
 /* Decimal adjust register A */
-void cpu_daa(void);
+void cpu_daa(GameBoy *gb);
 
 /* Complement A register */
-void cpu_cpl(void);
+void cpu_cpl(GameBoy *gb);
 
 /* Complement carry flag */
-void cpu_ccf(void);
+void cpu_ccf(GameBoy *gb);
 
 /* Set carry flag */
-void cpu_scf(void);
+void cpu_scf(GameBoy *gb);
 
 /* Power down CPU until an interrupt occurs */
-void cpu_halt(void);
+void cpu_halt(GameBoy *gb);
 
 /* Halt CPU & LCD display until button pressed */
-void cpu_stop(void);
+void cpu_stop(GameBoy *gb);
 
 /* Enable or disable interrupts */
-void cpu_ei(int enable);
+void cpu_ei(GameBoy *gb, int enable);
 
 /* Rotate register A to the left. Old bit 7 to carry flag */
-void cpu_rlca(void);
+void cpu_rlca(GameBoy *gb);
 
 /* Rotate register A left through carry flag */
-void cpu_rla(void);
+void cpu_rla(GameBoy *gb);
 
 /* Rotate register A right. Old bit 7 to carry flag */
-void cpu_rrca(void);
+void cpu_rrca(GameBoy *gb);
 
 /* Rotate register A right through carry flag */
-void cpu_rra(void);
+void cpu_rra(GameBoy *gb);
 
 /* Rotate register left through carry flag */
-void cpu_rl(BYTE *reg);
+void cpu_rl(GameBoy *gb, BYTE *reg);
 
-void cpu_rl_hl(WORD address);
+void cpu_rl_hl(GameBoy *gb, WORD address);
 
 
 /* Rotate register left. Old bit 7 to carry flag */
-void cpu_rlc(BYTE *reg);
+void cpu_rlc(GameBoy *gb, BYTE *reg);
 
-void cpu_rlc_hl(WORD address);
+void cpu_rlc_hl(GameBoy *gb, WORD address);
 
 /* Rotate register right. Old bit 7 to carry flag */
-void cpu_rrc(BYTE *reg);
+void cpu_rrc(GameBoy *gb, BYTE *reg);
 
-void cpu_rrc_hl(WORD address);
+void cpu_rrc_hl(GameBoy *gb, WORD address);
 
 /* Rotate register right through carry flag */
-void cpu_rr(BYTE *reg);
+void cpu_rr(GameBoy *gb, BYTE *reg);
 
-void cpu_rr_hl(WORD address);
+void cpu_rr_hl(GameBoy *gb, WORD address);
 
 /* Shift register left into carry. LSB of n set to 0 */
-void cpu_sla(BYTE *reg);
+void cpu_sla(GameBoy *gb, BYTE *reg);
 
-void cpu_sla_hl(WORD address);
+void cpu_sla_hl(GameBoy *gb, WORD address);
 
 /* Shift register right into carry. MSB doesn't change */
-void cpu_sra(BYTE *reg);
+void cpu_sra(GameBoy *gb, BYTE *reg);
 
-void cpu_sra_hl(WORD address);
+void cpu_sra_hl(GameBoy *gb, WORD address);
 
 /* Shift register right into carry. MSB set to 0 */
-void cpu_srl(BYTE *reg);
+void cpu_srl(GameBoy *gb, BYTE *reg);
 
-void cpu_srl_hl(WORD address);
+void cpu_srl_hl(GameBoy *gb, WORD address);
 
 /* Push two bytes of the register pair onto stack */
-void stack_push(const BYTE *hi, const BYTE *lo);
+void stack_push(GameBoy *gb, const BYTE *hi, const BYTE *lo);
 
 /* Pop two bytes off stack into register pair and increment Stack Pointer twice */
-void stack_pop(BYTE *hi, BYTE *lo);
+void stack_pop(GameBoy *gb, BYTE *hi, BYTE *lo);
 
 int test_bit(BYTE b, BYTE *reg);
 
@@ -1,56 +1,63 @@
-#include "cpu.h"
+#include "gameboy.h"
+#include "interrupts.h"
 #include "instructions.h"
+#include "scheduler.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
-void request_interrupt(BYTE bit) {
+/*  Interrupts
+    pending_interrupts holds IE & IF, and is worked out again whenever IF, IE or IME change instead of
+    on every check. Only when it is not 0 and IME is set does the scheduler get an EVENT_INTERRUPT,
+    so the CPU loop has nothing to test between instructions. The interrupt that is serviced is the
+    lowest pending bit, which is the one with the highest priority. The others stay requested in IF
+    until the handler has returned and enabled interrupts again.
+*/
+
+#define IF 0xFF0F
+#define IE 0xFFFF
+
+static int lowest_bit(BYTE bits) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return (int)index;
+#else
+    return __builtin_ctz(bits);
+#endif
+}
+
+void update_interrupts(GameBoy *gb) {
+    gb->pending_interrupts = gb->rom[IE] & gb->rom[IF] & 0x1F;
+    if (gb->pending_interrupts != 0 && gb->IME)
+        schedule_event(gb, EVENT_INTERRUPT, gb->total_cycles);
+}
+
+void request_interrupt(GameBoy *gb, BYTE bit) {
     // Request an interrupt by setting the corresponding bit in the Interrupt Flag
-    cpu_set_bit(bit, &rom[0xFF0F]);
+    gb->rom[IF] |= 1 << bit;
+    update_interrupts(gb);
     // Resume cpu execution if halt was set
-    reset_halt();
+    reset_halt(gb);
 }
 
-void execute_interrupt(int interrupt) {
+void execute_interrupt(GameBoy *gb, int interrupt) {
     // Disable interrupt master flag while executing an interrupt
-    IME = 0;
+    gb->IME = 0;
 
     // Push current PC onto stack
-    BYTE hi = (PC & 0xFF00) >> 8;
-    BYTE lo = (PC & 0x00FF);
-    stack_push(&hi, &lo);
-
-    cpu_reset_bit(interrupt, &rom[0xFF0F]);
-    // Set PC to corresponding ISR
-    switch (interrupt) {
-    case 0:
-        PC = 0x40;  // V-Blank
-        break;
-    case 1:
-        PC = 0x48;  // LCD STAT
-        break;
-    case 2:
-        PC = 0x50;  // Timer
-        break;
-    case 3:
-        PC = 0x58;  // Serial
-        break;
-    case 4:
-        PC = 0x60;  // Joypad
-        break;
-    }
+    BYTE hi = (gb->PC & 0xFF00) >> 8;
+    BYTE lo = (gb->PC & 0x00FF);
+    stack_push(gb, &hi, &lo);
+
+    gb->rom[IF] &= ~(1 << interrupt);
+    update_interrupts(gb);
+
+    // Set PC to the corresponding ISR: 0x40 V-Blank, 0x48 LCD STAT, 0x50 Timer, 0x58 Serial, 0x60 Joypad
+    gb->PC = 0x40 + interrupt * 8;
 }
 
-void interrupt_handler() {
-    if (IME == 1) {
-        BYTE interrupt_flag = rom[0xFF0F];
-        if (interrupt_flag > 0) {
-            for (int i = 4; i >= 0; i--) {
-                // Check if interrupt flag is set for x bit
-                if (test_bit(i, &rom[0xFF0F]) == 1) {
-                    // If interrupt is enabled, then execute it
-                    if (test_bit(i, &rom[0xFFFF])) {
-                        execute_interrupt(i);
-                    }
-                }
-            }
-        }
-    }
+void interrupt_handler(GameBoy *gb) {
+    if (gb->IME && gb->pending_interrupts != 0)
+        execute_interrupt(gb, lowest_bit(gb->pending_interrupts));
 }
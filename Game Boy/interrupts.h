@@ -1,11 +1,17 @@
 #ifndef INTERRUPTS_H
 #define INTERRUPTS_H
+#include "cpu.h"
 
 enum{
     VBLANK, LCD, TIMER, SERIAL, JOYPAD
 } INTERRUPT;
 
-void request_interrupt(BYTE bit);
-void interrupt_handler();
-void execute_interrupt(int interrupt);
+void request_interrupt(GameBoy *gb, BYTE bit);
+
+/* Service the pending interrupt with the highest priority, if IME is set */
+void interrupt_handler(GameBoy *gb);
+void execute_interrupt(GameBoy *gb, int interrupt);
+
+/* Work out pending_interrupts again after IF, IE or IME changed */
+void update_interrupts(GameBoy *gb);
 #endif
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include <stddef.h>
+#include "gameboy.h"
+#include "io_registers.h"
+#include "display.h"
+#include "scheduler.h"
+#include "interrupts.h"
+#include "dma.h"
+
+#define JOYPAD 0xFF00
+#define TAC 0xFF07
+#define IF 0xFF0F
+#define NR10 0xFF10
+#define NR51 0xFF25
+#define NR52 0xFF26
+#define STATUS 0xFF41
+#define LY 0xFF44
+#define DMA 0xFF46
+
+/* Bits of the sound registers from 0xFF10 to 0xFF2F that cannot be read back and always read as 1 */
+static const BYTE sound_read_mask[0x20] = {
+    0x80, 0x3F, 0x00, 0xFF, 0xBF,   // NR10-NR14
+    0xFF, 0x3F, 0x00, 0xFF, 0xBF,   // Unused, NR21-NR24
+    0x7F, 0xFF, 0x9F, 0xFF, 0xBF,   // NR30-NR34
+    0xFF, 0xFF, 0x00, 0x00, 0xBF,   // Unused, NR41-NR44
+    0x00, 0x00, 0x70,               // NR50-NR52
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF    // Unused
+};
+
+static BYTE read_stat(GameBoy *gb, WORD address) {
+    return gb->rom[address] | 0x80;     // Bit 7 is unused and always reads as 1
+}
+
+static BYTE read_sound(GameBoy *gb, WORD address) {
+    return gb->rom[address] | sound_read_mask[address - NR10];
+}
+
+// The first 4 bits of the joypad register are read only
+static void write_joypad(GameBoy *gb, WORD address, BYTE data) {
+    data &= 0xF0;
+    gb->rom[address] |= data;
+}
+
+// Timer control changes the timer frequency
+static void write_tac(GameBoy *gb, WORD address, BYTE data) {
+    sync_event(gb, EVENT_TIMER);
+    gb->rom[address] = data;
+    schedule_event(gb, EVENT_TIMER, gb->total_cycles);
+}
+
+// Interrupt flag can make an interrupt pending
+static void write_if(GameBoy *gb, WORD address, BYTE data) {
+    gb->rom[address] = data;
+    update_interrupts(gb);
+}
+
+// The sound registers ignore writes while the sound hardware is off
+static void write_sound(GameBoy *gb, WORD address, BYTE data) {
+    if (gb->rom[NR52] & 0x80)
+        gb->rom[address] = data;
+}
+
+// Only the power bit of NR52 can be written. Turning the sound off clears every sound register
+static void write_nr52(GameBoy *gb, WORD address, BYTE data) {
+    if (!(data & 0x80)) {
+        for (WORD i = NR10; i <= NR51; i++)
+            gb->rom[i] = 0;
+        gb->rom[address] &= 0x70;
+    }
+    else {
+        gb->rom[address] |= 0x80;
+    }
+}
+
+// LCD control can switch the display on and off, so the PPU needs to be caught up first
+static void write_lcdc(GameBoy *gb, WORD address, BYTE data) {
+    sync_event(gb, EVENT_PPU);
+    gb->rom[address] = data;
+    schedule_event(gb, EVENT_PPU, gb->total_cycles);
+}
+
+// The first 3 bits of the status register are read only
+static void write_stat(GameBoy *gb, WORD address, BYTE data) {
+    data &= ~0x07;
+    gb->rom[address] |= data;
+}
+
+// Writing to the scanline counter resets it
+static void write_ly(GameBoy *gb, WORD address, BYTE data) {
+    (void)data;
+    gb->rom[address] = 0;
+}
+
+// DMA transfer to OAM, which runs for the next 640 cycles
+static void write_dma(GameBoy *gb, WORD address, BYTE data) {
+    gb->rom[address] = data;
+    dma_start(gb, data);
+}
+
+/* Eight sound registers in a row */
+#define SOUND_READ_ROW read_sound, read_sound, read_sound, read_sound, read_sound, read_sound, read_sound, read_sound
+#define SOUND_WRITE_ROW write_sound, write_sound, write_sound, write_sound, write_sound, write_sound, write_sound, write_sound
+
+const IO_READ io_read_table[0x80] = {
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,     // 0xFF00
+    SOUND_READ_ROW, SOUND_READ_ROW,                                                                     // 0xFF10
+    SOUND_READ_ROW, SOUND_READ_ROW,                                                                     // 0xFF20
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,     // 0xFF30 Wave RAM
+    NULL, read_stat, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, // 0xFF40
+};
+
+const IO_WRITE io_write_table[0x80] = {
+    write_joypad, NULL, NULL, NULL, NULL, NULL, NULL, write_tac,                                        // 0xFF00
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL, write_if,
+    SOUND_WRITE_ROW, SOUND_WRITE_ROW,                                                                   // 0xFF10
+    write_sound, write_sound, write_sound, write_sound, write_sound, write_sound, write_nr52, NULL,      // 0xFF20
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,     // 0xFF30 Wave RAM
+    write_lcdc, write_stat, NULL, NULL, write_ly, NULL, write_dma, NULL,                                // 0xFF40
+};
@@ -0,0 +1,13 @@
+#ifndef IO_REGISTERS_H
+#define IO_REGISTERS_H
+#include "cpu.h"
+
+typedef BYTE (*IO_READ)(GameBoy *gb, WORD address);
+typedef void (*IO_WRITE)(GameBoy *gb, WORD address, BYTE data);
+
+/* Handlers for the I/O registers from 0xFF00 to 0xFF7F, indexed by the low 7 bits of the address.
+   A NULL entry is a plain register that is read and written as it is */
+extern const IO_READ io_read_table[0x80];
+extern const IO_WRITE io_write_table[0x80];
+
+#endif
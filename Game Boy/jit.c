@@ -0,0 +1,460 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include "gameboy.h"
+#include "emulator.h"
+#include "flags.h"
+#include "memory_map.h"
+#include "jit.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+/*  x86-64 code generation
+    A compiled block is a function that takes the GameBoy in the first argument register and keeps it
+    in RBX. Loads and stores between registers, immediates and memory are translated to native code,
+    using the read_page and write_page tables inline and calling read_memory() or write_memory() for
+    pages that need a handler. Every other instruction is a call to its handler in main_table or
+    cb_table, with PC and opcode set up the way the interpreter leaves them, so the flags engine and
+    everything with side effects behaves exactly as it does in the interpreter.
+
+    total_cycles is brought up to date before every call out of the block, so the scheduler sees the
+    same clock as it would with the interpreter. Events are only serviced between blocks, and a block
+    only runs as native code if all of it fits before stop_cycle (block_cache.c). A call out can
+    schedule an event that lowers stop_cycle into the block, so after each one the block compares it
+    with total_cycles at the start of its last instruction, kept on the stack, and if it is not past
+    that returns the number of instructions it has run for the interpreter to run the rest.
+*/
+
+#define JIT_MAX_OP_SIZE 192         // Longest code any one instruction compiles to, with its check and exit
+#define JIT_MAX_BLOCK_SIZE (BLOCK_MAX_OPS * JIT_MAX_OP_SIZE + 96)
+#define FIT_SLOT 32                 // Stack offset of the fit, above the 32 bytes a Win64 callee may use
+
+#define OFFSET(field) ((unsigned int)offsetof(GameBoy, field))
+
+typedef int (*NATIVE_BLOCK)(GameBoy *gb);
+
+/* Where the block returns early after an instruction, and what it has to bring up to date first */
+typedef struct {
+    BYTE *patch;            // rel32 of the jump to the exit
+    unsigned int cycles;    // Cycles of the instruction if it ran natively and are not yet in total_cycles
+    WORD pc;                // PC after the instruction if it ran natively, otherwise 0
+    int ops;                // Instructions run when it is taken
+} Exit;
+
+/* Offset of each 8-Bit register in opcode encoding order, 0 for (HL) */
+static const unsigned int reg_offset[8] = {
+    OFFSET(RegBC.hi), OFFSET(RegBC.lo), OFFSET(RegDE.hi), OFFSET(RegDE.lo),
+    OFFSET(RegHL.hi), OFFSET(RegHL.lo), 0, OFFSET(RegAF.hi)
+};
+
+/* Offset of BC, DE, HL and SP in the order of the 16-Bit operand field */
+static const unsigned int pair_offset[4] = {
+    OFFSET(RegBC), OFFSET(RegDE), OFFSET(RegHL), OFFSET(RegSP)
+};
+
+static BYTE *emit8(BYTE *p, BYTE value) {
+    *p++ = value;
+    return p;
+}
+
+static BYTE *emit16(BYTE *p, WORD value) {
+    memcpy(p, &value, 2);
+    return p + 2;
+}
+
+static BYTE *emit32(BYTE *p, unsigned int value) {
+    memcpy(p, &value, 4);
+    return p + 4;
+}
+
+static BYTE *emit64(BYTE *p, unsigned long long value) {
+    memcpy(p, &value, 8);
+    return p + 8;
+}
+
+/* Opcode bytes followed by a ModRM byte addressing [rbx + offset] */
+static BYTE *emit_rbx(BYTE *p, const char *opcode, int length, BYTE reg, unsigned int offset) {
+    for (int i = 0; i < length; i++)
+        p = emit8(p, (BYTE)opcode[i]);
+    p = emit8(p, 0x83 | (reg << 3));
+    return emit32(p, offset);
+}
+
+/* add qword [rbx + total_cycles], cycles */
+static BYTE *emit_add_cycles(BYTE *p, unsigned int cycles) {
+    if (cycles == 0)
+        return p;
+    p = emit_rbx(p, "\x48\x81", 2, 0, OFFSET(total_cycles));
+    return emit32(p, cycles);
+}
+
+/* mov byte [rbx + offset], value */
+static BYTE *emit_store_imm8(BYTE *p, unsigned int offset, BYTE value) {
+    p = emit_rbx(p, "\xC6", 1, 0, offset);
+    return emit8(p, value);
+}
+
+/* mov word [rbx + offset], value */
+static BYTE *emit_store_imm16(BYTE *p, unsigned int offset, WORD value) {
+    p = emit_rbx(p, "\x66\xC7", 2, 0, offset);
+    return emit16(p, value);
+}
+
+/* Call a C function with the GameBoy as its first argument */
+static BYTE *emit_call(BYTE *p, void *function) {
+#ifdef _WIN32
+    p = emit8(p, 0x48); p = emit8(p, 0x89); p = emit8(p, 0xD9);     // mov rcx, rbx
+#else
+    p = emit8(p, 0x48); p = emit8(p, 0x89); p = emit8(p, 0xDF);     // mov rdi, rbx
+#endif
+    p = emit8(p, 0x48); p = emit8(p, 0xB8);                         // mov rax, function
+    p = emit64(p, (unsigned long long)(size_t)function);
+    p = emit8(p, 0xFF); p = emit8(p, 0xD0);                         // call rax
+    return p;
+}
+
+/* Load the 16-Bit address at [rbx + address] into eax and the page pointer for it from table into rdx,
+   then jump to the returned patch point if the page needs a handler */
+static BYTE *emit_page_lookup(BYTE *p, unsigned int address, unsigned int table, BYTE **patch) {
+    p = emit_rbx(p, "\x0F\xB7", 2, 0, address);                     // movzx eax, word [rbx + address]
+    p = emit8(p, 0x89); p = emit8(p, 0xC1);                         // mov ecx, eax
+    p = emit8(p, 0xC1); p = emit8(p, 0xE9); p = emit8(p, 0x08);     // shr ecx, 8
+    p = emit8(p, 0x48); p = emit8(p, 0x8B); p = emit8(p, 0x94);     // mov rdx, [rbx + rcx * 8 + table]
+    p = emit8(p, 0xCB); p = emit32(p, table);
+    p = emit8(p, 0x48); p = emit8(p, 0x85); p = emit8(p, 0xD2);     // test rdx, rdx
+    p = emit8(p, 0x74); *patch = p; p = emit8(p, 0);                // jz handler
+    p = emit8(p, 0x0F); p = emit8(p, 0xB6); p = emit8(p, 0xC0);     // movzx eax, al
+    return p;
+}
+
+static void patch_jump(BYTE *patch, BYTE *target) {
+    *patch = (BYTE)(target - (patch + 1));
+}
+
+static void patch_jump32(BYTE *patch, BYTE *target) {
+    unsigned int offset = (unsigned int)(target - (patch + 4));
+    memcpy(patch, &offset, 4);
+}
+
+/* Jump to the returned patch point if stop_cycle is at or before the fit */
+static BYTE *emit_check_stop(BYTE *p, BYTE **patch) {
+    p = emit_rbx(p, "\x48\x8B", 2, 0, OFFSET(stop_cycle));          // mov rax, [rbx + stop_cycle]
+    p = emit8(p, 0x48); p = emit8(p, 0x3B); p = emit8(p, 0x44);     // cmp rax, [rsp + FIT_SLOT]
+    p = emit8(p, 0x24); p = emit8(p, FIT_SLOT);
+    p = emit8(p, 0x0F); p = emit8(p, 0x86);                         // jbe exit
+    *patch = p;
+    return emit32(p, 0);
+}
+
+/* register at [rbx + value] = memory at the address in [rbx + address] */
+static BYTE *emit_load(BYTE *p, unsigned int address, unsigned int value) {
+    BYTE *to_handler, *to_done;
+    p = emit_page_lookup(p, address, OFFSET(read_page), &to_handler);
+    p = emit8(p, 0x0F); p = emit8(p, 0xB6);                         // movzx eax, byte [rdx + rax]
+    p = emit8(p, 0x04); p = emit8(p, 0x02);
+    p = emit8(p, 0xEB); to_done = p; p = emit8(p, 0);               // jmp done
+
+    patch_jump(to_handler, p);
+#ifdef _WIN32
+    p = emit8(p, 0x89); p = emit8(p, 0xC2);                         // mov edx, eax
+#else
+    p = emit8(p, 0x89); p = emit8(p, 0xC6);                         // mov esi, eax
+#endif
+    p = emit_call(p, (void *)read_memory);
+
+    patch_jump(to_done, p);
+    return emit_rbx(p, "\x88", 1, 0, value);                        // mov [rbx + value], al
+}
+
+/* memory at the address in [rbx + address] = register at [rbx + value] */
+static BYTE *emit_store(BYTE *p, unsigned int address, unsigned int value) {
+    BYTE *to_handler, *to_done;
+    p = emit_page_lookup(p, address, OFFSET(write_page), &to_handler);
+    p = emit_rbx(p, "\x0F\xB6", 2, 1, value);                       // movzx ecx, byte [rbx + value]
+    p = emit8(p, 0x88); p = emit8(p, 0x0C); p = emit8(p, 0x02);     // mov [rdx + rax], cl
+    p = emit8(p, 0xEB); to_done = p; p = emit8(p, 0);               // jmp done
+
+    patch_jump(to_handler, p);
+#ifdef _WIN32
+    p = emit8(p, 0x89); p = emit8(p, 0xC2);                         // mov edx, eax
+    p = emit_rbx(p, "\x44\x0F\xB6", 3, 0, value);                   // movzx r8d, byte [rbx + value]
+#else
+    p = emit8(p, 0x89); p = emit8(p, 0xC6);                         // mov esi, eax
+    p = emit_rbx(p, "\x0F\xB6", 2, 2, value);                       // movzx edx, byte [rbx + value]
+#endif
+    p = emit_call(p, (void *)write_memory);
+
+    patch_jump(to_done, p);
+    return p;
+}
+
+/* inc or dec word [rbx + offset] */
+static BYTE *emit_step_pair(BYTE *p, unsigned int offset, int step) {
+    return emit_rbx(p, "\x66\xFF", 2, step > 0 ? 0 : 1, offset);
+}
+
+/* Translate one instruction to native code. Returns NULL if it has to go through its handler,
+   otherwise sets length to the number of bytes the instruction takes up */
+static BYTE *compile_op(BYTE *p, GameBoy *gb, const MicroOp *op, int *length) {
+    BYTE opcode = op->opcode;
+    BYTE n = MEMORY_AT(gb, op->operands);
+    WORD nn = n | (MEMORY_AT(gb, op->operands + 1) << 8);
+    unsigned int dst = reg_offset[(opcode >> 3) & 0x07];
+    unsigned int src = reg_offset[opcode & 0x07];
+
+    if (op->operands != (WORD)(op->pc + 1))     // CB prefixed
+        return NULL;
+
+    *length = 1;
+    if (opcode == 0x00)                                                 // NOP
+        return p;
+    if (opcode >= 0x40 && opcode < 0x80 && opcode != 0x76) {
+        if (dst == 0)                                                   // LD (HL), r
+            return emit_store(p, OFFSET(RegHL), src);
+        if (src == 0)                                                   // LD r, (HL)
+            return emit_load(p, OFFSET(RegHL), dst);
+        p = emit_rbx(p, "\x0F\xB6", 2, 0, src);                         // LD r, r
+        return emit_rbx(p, "\x88", 1, 0, dst);
+    }
+    if ((opcode & 0xC7) == 0x06 && opcode != 0x36) {                    // LD r, n
+        *length = 2;
+        return emit_store_imm8(p, dst, n);
+    }
+
+    switch (opcode) {
+    case 0x01: case 0x11: case 0x21: case 0x31:                         // LD rr, nn
+        *length = 3;
+        return emit_store_imm16(p, pair_offset[opcode >> 4], nn);
+    case 0x03: case 0x13: case 0x23: case 0x33:                         // INC rr
+        return emit_step_pair(p, pair_offset[opcode >> 4], 1);
+    case 0x0B: case 0x1B: case 0x2B: case 0x3B:                         // DEC rr
+        return emit_step_pair(p, pair_offset[opcode >> 4], -1);
+    case 0x02: case 0x12:                                               // LD (BC), A / LD (DE), A
+        return emit_store(p, pair_offset[opcode >> 4], OFFSET(RegAF.hi));
+    case 0x0A: case 0x1A:                                               // LD A, (BC) / LD A, (DE)
+        return emit_load(p, pair_offset[opcode >> 4], OFFSET(RegAF.hi));
+    case 0x22: case 0x32:                                               // LDI/LDD (HL), A
+        p = emit_store(p, OFFSET(RegHL), OFFSET(RegAF.hi));
+        return emit_step_pair(p, OFFSET(RegHL), opcode == 0x22 ? 1 : -1);
+    case 0x2A: case 0x3A:                                               // LDI/LDD A, (HL)
+        p = emit_load(p, OFFSET(RegHL), OFFSET(RegAF.hi));
+        return emit_step_pair(p, OFFSET(RegHL), opcode == 0x2A ? 1 : -1);
+    default:
+        return NULL;
+    }
+}
+
+/* 1 if the native code for the instruction reaches read_memory() or write_memory() for pages that
+   need a handler, the only calls out of an instruction compile_op() translates */
+static int native_memory(BYTE opcode) {
+    if (opcode >= 0x40 && opcode < 0x80)
+        return (opcode & 0x07) == 6 || ((opcode >> 3) & 0x07) == 6;
+    switch (opcode) {
+    case 0x02: case 0x12: case 0x0A: case 0x1A: case 0x22: case 0x32: case 0x2A: case 0x3A:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* Compile the block to native code at p. Returns the end of the code */
+static BYTE *compile_block(BYTE *p, GameBoy *gb, const Block *block) {
+    unsigned int pending = 0;   // Cycles of native instructions not yet added to total_cycles
+    WORD next_pc = 0;           // PC after the last instruction, if it was compiled to native code
+    Exit exits[BLOCK_MAX_OPS];
+    int exit_count = 0;
+
+    p = emit8(p, 0x53);                                             // push rbx
+    p = emit8(p, 0x48); p = emit8(p, 0x83); p = emit8(p, 0xEC);     // sub rsp, 48
+    p = emit8(p, 0x30);
+#ifdef _WIN32
+    p = emit8(p, 0x48); p = emit8(p, 0x89); p = emit8(p, 0xCB);     // mov rbx, rcx
+#else
+    p = emit8(p, 0x48); p = emit8(p, 0x89); p = emit8(p, 0xFB);     // mov rbx, rdi
+#endif
+    p = emit_rbx(p, "\x48\x8B", 2, 0, OFFSET(total_cycles));        // mov rax, [rbx + total_cycles]
+    p = emit8(p, 0x48); p = emit8(p, 0x05);                         // add rax, body_cycles
+    p = emit32(p, block->body_cycles);
+    p = emit8(p, 0x48); p = emit8(p, 0x89); p = emit8(p, 0x44);     // mov [rsp + FIT_SLOT], rax
+    p = emit8(p, 0x24); p = emit8(p, FIT_SLOT);
+
+    for (int i = 0; i < block->count; i++) {
+        const MicroOp *op = &block->ops[i];
+        int length = 0;
+        int calls_out = 1;
+
+        // Anything that can reach a handler sees total_cycles as of the start of the instruction
+        p = emit_add_cycles(p, pending);
+        pending = 0;
+
+        BYTE *native = compile_op(p, gb, op, &length);
+        if (native != NULL) {
+            p = native;
+            pending += op->cycles;
+            next_pc = op->pc + length;
+            calls_out = native_memory(op->opcode);
+        }
+        else {
+            p = emit_store_imm16(p, OFFSET(PC), op->operands);
+            p = emit_store_imm8(p, OFFSET(opcode), op->opcode);
+            p = emit_call(p, (void *)op->handler);
+            p = emit8(p, 0x48); p = emit8(p, 0x98);                 // cdqe
+            p = emit_rbx(p, "\x48\x01", 2, 0, OFFSET(total_cycles));    // add [rbx + total_cycles], rax
+            next_pc = 0;
+        }
+
+        if (calls_out && i < block->count - 1) {
+            Exit *exit = &exits[exit_count++];
+            p = emit_check_stop(p, &exit->patch);
+            exit->cycles = native != NULL ? op->cycles : 0;
+            exit->pc = native != NULL ? next_pc : 0;
+            exit->ops = i + 1;
+        }
+    }
+
+    p = emit_add_cycles(p, pending);
+    if (next_pc != 0)
+        p = emit_store_imm16(p, OFFSET(PC), next_pc);
+    p = emit8(p, 0xB8); p = emit32(p, block->count);               // mov eax, count
+
+    BYTE *epilogue = p;
+    p = emit8(p, 0x48); p = emit8(p, 0x83); p = emit8(p, 0xC4);     // add rsp, 48
+    p = emit8(p, 0x30);
+    p = emit8(p, 0x5B);                                             // pop rbx
+    p = emit8(p, 0xC3);                                             // ret
+
+    // Out of line, so the checks cost a compare and a branch that is not taken
+    for (int i = 0; i < exit_count; i++) {
+        patch_jump32(exits[i].patch, p);
+        p = emit_add_cycles(p, exits[i].cycles);
+        if (exits[i].pc != 0)
+            p = emit_store_imm16(p, OFFSET(PC), exits[i].pc);
+        p = emit8(p, 0xB8); p = emit32(p, exits[i].ops);           // mov eax, ops
+        p = emit8(p, 0xE9);                                         // jmp epilogue
+        p = emit32(p, (unsigned int)(epilogue - (p + 4)));
+    }
+    return p;
+}
+
+static BYTE *alloc_code(void) {
+#ifdef _WIN32
+    return VirtualAlloc(NULL, JIT_CODE_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+    void *code = mmap(NULL, JIT_CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return code == MAP_FAILED ? NULL : code;
+#endif
+}
+
+static void free_code(BYTE *code) {
+#ifdef _WIN32
+    VirtualFree(code, 0, MEM_RELEASE);
+#else
+    munmap(code, JIT_CODE_SIZE);
+#endif
+}
+
+void jit_reset(GameBoy *gb) {
+    if (gb->blocks != NULL) {
+        for (int i = 0; i < BLOCK_CACHE_SIZE; i++)
+            gb->blocks[i].native = NULL;
+    }
+    gb->jit_used = 0;
+}
+
+void jit_free(GameBoy *gb) {
+    if (gb->jit_code != NULL)
+        free_code(gb->jit_code);
+    gb->jit_code = NULL;
+    gb->jit_used = 0;
+    free(gb->jit_shadow);
+    gb->jit_shadow = NULL;
+}
+
+static int compile(GameBoy *gb, Block *block) {
+    if (gb->jit_code == NULL && (gb->jit_code = alloc_code()) == NULL)
+        return 1;
+
+    // Start over once the buffer is full. Blocks that are still hot are compiled again
+    if (gb->jit_used + JIT_MAX_BLOCK_SIZE > JIT_CODE_SIZE)
+        jit_reset(gb);
+
+    BYTE *start = gb->jit_code + gb->jit_used;
+    BYTE *end = compile_block(start, gb, block);
+    gb->jit_used += (unsigned int)(end - start);
+    block->native = (NATIVE_BLOCK)start;
+    return 0;
+}
+
+/* Run the block in the interpreter on a copy of the GameBoy, then natively, and report any difference.
+   Returns the instructions run natively */
+static int check_block(GameBoy *gb, Block *block) {
+    if (gb->jit_shadow == NULL && (gb->jit_shadow = malloc(sizeof(GameBoy))) == NULL)
+        return block->native(gb);
+    GameBoy *shadow = gb->jit_shadow;
+    memcpy(shadow, gb, sizeof(GameBoy));
+    // The copy must not touch the real instance's memory, its block cache or its save file. Its
+    // pages, and the banks mbc.c maps, are pointed at its own memory again. That counts as a bank
+    // switch, which stops the instructions being run, so the copy takes stop_cycle back afterwards
+    shadow->save = NULL;
+    memory_map_init(shadow);
+    shadow->stop_cycle = gb->stop_cycle;
+    memset(shadow->code_map, 0, sizeof(shadow->code_map));
+    shadow->blocks = NULL;
+    shadow->jit_code = NULL;
+    shadow->jit_shadow = NULL;
+
+    // The interpreter stops where the native code has to, once an instruction lowers stop_cycle
+    // to the start of the last instruction or before
+    unsigned long long fit = shadow->total_cycles + block->body_cycles;
+    int ops = 0;
+    while (ops < block->count) {
+        shadow->total_cycles += execute(shadow);
+        if (++ops < block->count && shadow->stop_cycle <= fit)
+            break;
+    }
+    int native_ops = block->native(gb);
+
+    sync_flags(shadow);
+    sync_flags(gb);
+    if (shadow->RegAF.data != gb->RegAF.data || shadow->RegBC.data != gb->RegBC.data
+        || shadow->RegDE.data != gb->RegDE.data || shadow->RegHL.data != gb->RegHL.data
+        || shadow->RegSP.data != gb->RegSP.data || shadow->PC != gb->PC
+        || shadow->IME != gb->IME || shadow->HALT != gb->HALT
+        || shadow->total_cycles != gb->total_cycles || ops != native_ops
+        || memcmp(shadow->rom, gb->rom, sizeof(gb->rom)) != 0
+        || memcmp(shadow->ram_banks, gb->ram_banks, sizeof(gb->ram_banks)) != 0) {
+        gb->jit_mismatches++;
+        fprintf_s(stderr, "jit: block %04X differs from the interpreter at cycle %llu\n"
+            "  interpreter AF=%04X BC=%04X DE=%04X HL=%04X SP=%04X PC=%04X cycles=%llu ops=%d\n"
+            "  native      AF=%04X BC=%04X DE=%04X HL=%04X SP=%04X PC=%04X cycles=%llu ops=%d\n",
+            block->start, gb->total_cycles,
+            shadow->RegAF.data, shadow->RegBC.data, shadow->RegDE.data, shadow->RegHL.data,
+            shadow->RegSP.data, shadow->PC, shadow->total_cycles, ops,
+            gb->RegAF.data, gb->RegBC.data, gb->RegDE.data, gb->RegHL.data,
+            gb->RegSP.data, gb->PC, gb->total_cycles, native_ops);
+    }
+    return native_ops;
+}
+
+int jit_run_block(GameBoy *gb, Block *block) {
+    if (block->native == NULL) {
+        // Only ROM cannot change under a compiled block
+        if (block->end > 0x8000)
+            return 0;
+        if (block->hits < JIT_THRESHOLD) {
+            block->hits++;
+            return 0;
+        }
+        if (compile(gb, block) != 0)
+            return 0;
+    }
+
+    if (gb->engine == ENGINE_JIT_CHECK)
+        return check_block(gb, block);
+    return block->native(gb);
+}
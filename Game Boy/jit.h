@@ -0,0 +1,20 @@
+#ifndef JIT_H
+#define JIT_H
+#include "cpu.h"
+#include "block_cache.h"
+
+#define JIT_THRESHOLD 16            // Times a block is interpreted before it is compiled
+#define JIT_CODE_SIZE (1 << 20)     // Bytes of native code each instance can hold
+
+/* Run a cached block as native code, compiling it first once it has run JIT_THRESHOLD times.
+   Only blocks decoded from cartridge ROM are compiled. Returns the number of instructions run, which
+   is fewer than the block has if one of them lowered stop_cycle into it, or 0 if the block was not
+   run. The caller interprets the rest */
+int jit_run_block(GameBoy *gb, Block *block);
+
+/* Drop all native code. Called when the block cache is reset */
+void jit_reset(GameBoy *gb);
+
+void jit_free(GameBoy *gb);
+
+#endif
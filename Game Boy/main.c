@@ -1,23 +1,166 @@
 #include "cpu.h"
-#include "instructions.h"
-#include "interrupts.h"
-#include "timer.h"
 #include "display.h"
+#include "emulator.h"
+#include "batch.h"
+#include "benchmark.h"
+#include "aot.h"
+#include "debugger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* interpreter, jit or jit-check. Returns -1 for anything else */
+static int parse_engine(const char *name)
+{
+   if (strcmp(name, "interpreter") == 0) {
+      return ENGINE_INTERPRETER;
+   }
+   if (strcmp(name, "jit") == 0) {
+      return ENGINE_JIT;
+   }
+   if (strcmp(name, "jit-check") == 0) {
+      return ENGINE_JIT_CHECK;
+   }
+   return -1;
+}
+
+/* Game Boy.exe --batch <rom> <instances> <frames> [threads] [engine]
+   Runs many headless copies of one ROM and prints the aggregate frame rate */
+static int batch_main(int argc, const char* argv[])
+{
+   if (argc < 5) {
+      printf("usage: %s --batch <rom> <instances> <frames> [threads] [interpreter|jit|jit-check]\n", argv[0]);
+      return 1;
+   }
+   int count = atoi(argv[3]);
+   unsigned int frames = (unsigned int)atoi(argv[4]);
+   int threads = argc > 5 ? atoi(argv[5]) : 0;
+   int engine = argc > 6 ? parse_engine(argv[6]) : ENGINE_INTERPRETER;
+   if (count <= 0 || engine < 0) {
+      return 1;
+   }
+
+   BatchInstance *instances = calloc(count, sizeof(BatchInstance));
+   if (instances == NULL) {
+      return 1;
+   }
+   for (int i = 0; i < count; i++) {
+      instances[i].filename = (char *)argv[2];
+      instances[i].engine = engine;
+   }
+
+   BatchReport report;
+   int result = run_batch(instances, count, frames, threads, &report);
+   if (result == 0) {
+      printf("%d instances, %d threads: %llu frames in %.3f s, %.1f frames/sec\n",
+         count, report.threads, report.frames, report.seconds, report.frames_per_second);
+      printf("%llu cycles skipped in idle loops\n", report.idle_cycles_skipped);
+      printf("%llu cycles of OAM DMA\n", report.dma_cycles);
+   }
+   free_batch(instances, count);
+   free(instances);
+   return result;
+}
+
+/* Game Boy.exe --aot <rom> <output.c>
+   Translates the ROM to C. Add the output to the build and set AOT to run it */
+static int aot_main(int argc, const char* argv[])
+{
+   if (argc < 4) {
+      printf("usage: %s --aot <rom> <output.c>\n", argv[0]);
+      return 1;
+   }
+   return aot_translate((char *)argv[2], argv[3]);
+}
+
+/* Game Boy.exe --bench-alu [frames]
+   Times the flags engine (FLAG_MODE) and dispatch engine this build was compiled with on a loop of
+   arithmetic and on a loop of register to register instructions */
+static int bench_main(int argc, const char* argv[])
+{
+   unsigned int frames = argc > 2 ? (unsigned int)atoi(argv[2]) : 3600;
+   BenchmarkReport report;
+   alu_benchmark(frames, &report);
+   printf("flags %s: %llu cycles in %.3f s, %.1f MHz (%.1fx real time)\n",
+      report.engine, report.cycles, report.seconds, report.mhz, report.mhz / 4.194304);
+   register_benchmark(frames, &report);
+   printf("dispatch %s, registers: %llu instructions in %.3f s, %.1f MIPS (%.1f MHz)\n",
+      report.dispatch, report.instructions, report.seconds, report.mips, report.mhz);
+   return 0;
+}
+
+/* Game Boy.exe --disassemble <rom> [address] [count]
+   Prints count instructions from address (in hex). Starts at 0100 and prints 32 if they are left out */
+static int disassemble_main(int argc, const char* argv[])
+{
+   if (argc < 3) {
+      printf("usage: %s --disassemble <rom> [address] [count]\n", argv[0]);
+      return 1;
+   }
+   GameBoy *gb = create_gameboy();
+   if (gb == NULL) {
+      return 1;
+   }
+   cpu_init(gb);
+   if (load_rom(gb, (char *)argv[2]) != 0) {
+      destroy_gameboy(gb);
+      return 1;
+   }
+   WORD address = argc > 3 ? (WORD)strtol(argv[3], NULL, 16) : 0x100;
+   int count = argc > 4 ? atoi(argv[4]) : 32;
+   char text[32];
+   for (int i = 0; i < count; i++) {
+      int length = disassemble(gb, address, text, sizeof(text));
+      printf("%04X  %s\n", address, text);
+      address += length;
+   }
+   destroy_gameboy(gb);
+   return 0;
+}
 
-unsigned int num_cycles = 0;
 int main(int argc, const char* argv[])
 {
-   cpu_init();
-   load_rom("tetris.gb");
-   if (display_init() == 1) {
+   if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+      return batch_main(argc, argv);
+   }
+   if (argc > 1 && strcmp(argv[1], "--aot") == 0) {
+      return aot_main(argc, argv);
+   }
+   if (argc > 1 && strcmp(argv[1], "--disassemble") == 0) {
+      return disassemble_main(argc, argv);
+   }
+   if (argc > 1 && strcmp(argv[1], "--bench-alu") == 0) {
+      return bench_main(argc, argv);
+   }
+   // Game Boy.exe [--engine interpreter|jit|jit-check] [rom]
+   int engine = ENGINE_INTERPRETER;
+   if (argc > 2 && strcmp(argv[1], "--engine") == 0) {
+      engine = parse_engine(argv[2]);
+      argc -= 2;
+      argv += 2;
+   }
+   char *filename = argc > 1 ? (char *)argv[1] : "tetris.gb";
+   GameBoy *gb = create_gameboy();
+   if (engine < 0 || gb == NULL) {
+      return 1;
+   }
+   set_battery_saves(gb, 1);
+   if (power_on(gb, filename) == 1) {
+      return 1;
+   }
+   if (set_engine(gb, engine) != 0) {
+      printf("this build has no JIT, using the interpreter\n");
+   }
+   if (display_init(gb) != 0) {
       return 1;
    }
-    while (1)
+    while (!display_closed())
     {
-            num_cycles = execute();
-            draw(num_cycles);
-            timer(num_cycles);
-            interrupt_handler();
+            run_frame(gb);
+            render_display(gb);
             //handle_input();
     }
+   // Writes back battery backed RAM
+   destroy_gameboy(gb);
+   return 0;
 }
\ No newline at end of file
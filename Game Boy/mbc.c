@@ -0,0 +1,214 @@
+#include <stddef.h>
+#include <string.h>
+#include "gameboy.h"
+#include "mbc.h"
+#include "memory_map.h"
+#include "battery.h"
+#include "rtc.h"
+
+/*  Memory bank controllers
+    The whole cartridge stays in cartridge_memory and its RAM in ram_banks. Selecting a bank points
+    the pages of 4000-7FFF, or of A000-BFFF for RAM, at the bank, so a switch costs a few stores into
+    the page tables and nothing is copied, however many times a frame a game switches. 0000-3FFF is
+    bank 0, except in MBC1 mode 1, where the upper bank bits apply to it as well.
+
+    RAM that is saved to a file (battery.c) only has write pages for the pages written since the
+    last save, so the first write to each page comes here to be marked dirty.
+
+    The registers are written through the ROM pages, which have no write page, so write_memory()
+    passes writes below 0x8000 on to mbc_write(). Disabled external RAM, and RAM with an MBC3 clock
+    register selected, is taken out of the read and write pages so accesses come here instead, and
+    the clock registers are passed on to rtc.c.
+
+    Anything that keeps code by address has to allow for the bank. Cached blocks remember the memory
+    their first page was mapped to (block_cache.c), external RAM is not cached at all with a controller,
+    and translated blocks only run while their pages are mapped where they were translated from (aot.c).
+    A switch that changes the ROM mapping also lowers stop_cycle to the current cycle, so a block that
+    switches its own bank stops at the write in every engine and the next instruction is fetched from
+    the new bank.
+*/
+
+#define RAM_DISABLED 0xFF   // What disabled external RAM reads as
+#define MBC3_RTC_SELECT 0x08 // RAM bank values from here on select a clock register
+
+static int rtc_mapped(GameBoy *gb) {
+    return gb->rtc && gb->ram_enabled && gb->ram_bank >= MBC3_RTC_SELECT && gb->ram_bank < MBC3_RTC_SELECT + RTC_REGISTERS;
+}
+
+/* Bytes of RAM for each value of the RAM size at 0x0149 */
+static const unsigned int ram_sizes[] = { 0, 0x800, 0x2000, 0x8000, 0x20000, 0x10000 };
+
+static int ram_mapped(GameBoy *gb) {
+    if (!gb->ram_enabled || gb->ram_size == 0)
+        return 0;
+    return gb->mbc != MBC_3 || gb->ram_bank < MBC3_RTC_SELECT;
+}
+
+/* Offset into ram_banks of the selected bank */
+static unsigned int ram_offset(GameBoy *gb) {
+    unsigned int bank = gb->ram_bank;
+    if (gb->mbc == MBC_1)
+        bank = gb->banking_mode ? bank & 0x03 : 0;
+    unsigned int banks = gb->ram_size > RAM_BANK_SIZE ? gb->ram_size / RAM_BANK_SIZE : 1;
+    return (bank & (banks - 1)) * RAM_BANK_SIZE;
+}
+
+static void map_rom(GameBoy *gb) {
+    unsigned int low = 0;
+    unsigned int high = gb->rom_bank;
+    if (gb->mbc == MBC_1) {
+        // The lower 5 bits cannot select bank 0, so 0x00, 0x20, 0x40 and 0x60 map the bank after
+        high = (gb->ram_bank & 0x03) << 5 | (gb->rom_bank & 0x1F ? gb->rom_bank & 0x1F : 1);
+        low = gb->banking_mode ? (gb->ram_bank & 0x03) << 5 : 0;
+    }
+    BYTE *low_bank = gb->cartridge_memory + (low & gb->rom_bank_mask) * ROM_BANK_SIZE;
+    BYTE *high_bank = gb->cartridge_memory + (high & gb->rom_bank_mask) * ROM_BANK_SIZE;
+
+    // Code may be running from the bank that goes, so stop the instructions being run at this one
+    if ((gb->memory_page[0x00] != low_bank || gb->memory_page[0x40] != high_bank) && gb->stop_cycle > gb->total_cycles)
+        gb->stop_cycle = gb->total_cycles;
+    map_pages(gb->read_page, 0x00, 0x3F, low_bank);
+    map_pages(gb->memory_page, 0x00, 0x3F, low_bank);
+    map_pages(gb->read_page, 0x40, 0x7F, high_bank);
+    map_pages(gb->memory_page, 0x40, 0x7F, high_bank);
+}
+
+static void map_ram(GameBoy *gb) {
+    BYTE *bank = &gb->ram_banks[ram_offset(gb)];
+    BYTE *mapped = ram_mapped(gb) ? bank : NULL;
+
+    map_pages(gb->read_page, 0xA0, 0xBF, mapped);
+    map_pages(gb->write_page, 0xA0, 0xBF, mapped);
+    map_pages(gb->memory_page, 0xA0, 0xBF, bank);
+    if (gb->save != NULL && mapped != NULL) {
+        unsigned int first = ram_offset(gb) / PAGE_SIZE;
+        for (unsigned int page = 0; page < RAM_BANK_SIZE / PAGE_SIZE; page++) {
+            if (!gb->ram_dirty[first + page])
+                gb->write_page[0xA0 + page] = NULL;
+        }
+    }
+}
+
+void mbc_init(GameBoy *gb) {
+    BYTE type = gb->cartridge_memory[0x0147];
+    BYTE ram_size = gb->cartridge_memory[0x0149];
+
+    if (type >= 0x01 && type <= 0x03)
+        gb->mbc = MBC_1;
+    else if (type >= 0x0F && type <= 0x13)
+        gb->mbc = MBC_3;
+    else if (type >= 0x19 && type <= 0x1E)
+        gb->mbc = MBC_5;
+    else
+        gb->mbc = MBC_NONE;
+
+    gb->ram_size = gb->mbc != MBC_NONE && ram_size < sizeof(ram_sizes) / sizeof(ram_sizes[0]) ? ram_sizes[ram_size] : 0;
+    gb->battery = type == 0x03 || type == 0x0F || type == 0x10 || type == 0x13 || type == 0x1B || type == 0x1E;
+    gb->rtc = type == 0x0F || type == 0x10;
+    rtc_init(gb);
+    gb->rom_bank_mask = gb->cartridge_size / ROM_BANK_SIZE - 1;
+    gb->rom_bank = 1;
+    gb->ram_bank = 0;
+    gb->ram_enabled = 0;
+    gb->banking_mode = 0;
+    // Nothing is left over from the last cartridge, battery_open() loads any save after this
+    memset(gb->ram_banks, 0, sizeof(gb->ram_banks));
+    mbc_map(gb);
+}
+
+void mbc_map(GameBoy *gb) {
+    if (gb->cartridge_memory == NULL)
+        return;
+    map_rom(gb);
+    // Without a controller, A000-BFFF stays plain memory in rom[]
+    if (gb->mbc != MBC_NONE)
+        map_ram(gb);
+}
+
+void mbc_write(GameBoy *gb, WORD address, BYTE data) {
+    switch (gb->mbc) {
+    case MBC_1:
+        if (address < 0x2000) {
+            gb->ram_enabled = (data & 0x0F) == 0x0A;
+            map_ram(gb);
+        }
+        else if (address < 0x4000) {
+            gb->rom_bank = data & 0x1F;
+            map_rom(gb);
+        }
+        else if (address < 0x6000) {
+            gb->ram_bank = data & 0x03;
+            map_rom(gb);
+            map_ram(gb);
+        }
+        else {
+            gb->banking_mode = data & 0x01;
+            map_rom(gb);
+            map_ram(gb);
+        }
+        break;
+
+    case MBC_3:
+        if (address < 0x2000) {
+            gb->ram_enabled = (data & 0x0F) == 0x0A;
+            map_ram(gb);
+        }
+        else if (address < 0x4000) {
+            gb->rom_bank = data & 0x7F ? data & 0x7F : 1;
+            map_rom(gb);
+        }
+        else if (address < 0x6000) {
+            gb->ram_bank = data & 0x0F;
+            map_ram(gb);
+        }
+        else if (gb->rtc) {
+            rtc_latch(gb, data);
+        }
+        break;
+
+    case MBC_5:
+        if (address < 0x2000) {
+            gb->ram_enabled = data == 0x0A;
+            map_ram(gb);
+        }
+        else if (address < 0x3000) {
+            gb->rom_bank = (gb->rom_bank & 0x100) | data;
+            map_rom(gb);
+        }
+        else if (address < 0x4000) {
+            gb->rom_bank = (data & 0x01) << 8 | (gb->rom_bank & 0xFF);
+            map_rom(gb);
+        }
+        else if (address < 0x6000) {
+            gb->ram_bank = data & 0x0F;
+            map_ram(gb);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+BYTE mbc_read_ram(GameBoy *gb, WORD address) {
+    if (rtc_mapped(gb))
+        return rtc_read(gb, gb->ram_bank - MBC3_RTC_SELECT);
+    if (!ram_mapped(gb))
+        return RAM_DISABLED;
+    return gb->ram_banks[ram_offset(gb) + (address - 0xA000)];
+}
+
+void mbc_write_ram(GameBoy *gb, WORD address, BYTE data) {
+    if (rtc_mapped(gb)) {
+        rtc_write(gb, gb->ram_bank - MBC3_RTC_SELECT, data);
+        return;
+    }
+    if (!ram_mapped(gb))
+        return;
+    unsigned int offset = ram_offset(gb) + (address - 0xA000);
+    gb->ram_banks[offset] = data;
+    if (gb->save != NULL && !gb->ram_dirty[offset / PAGE_SIZE]) {
+        battery_dirty(gb, offset / PAGE_SIZE);
+        gb->write_page[address >> 8] = &gb->ram_banks[offset & ~(PAGE_SIZE - 1)];
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef MBC_H
+#define MBC_H
+#include "cpu.h"
+
+#define ROM_BANK_SIZE 0x4000
+#define RAM_BANK_SIZE 0x2000
+
+/* Memory bank controller of the cartridge, from the cartridge type at 0x0147 */
+typedef enum {
+    MBC_NONE,
+    MBC_1,
+    MBC_3,
+    MBC_5
+} MBC;
+
+/* Work out the controller and the RAM size from the header of the loaded cartridge and select
+   the first banks. Called by load_rom() */
+void mbc_init(GameBoy *gb);
+
+/* Point the ROM and external RAM pages at the selected banks. Does nothing until a cartridge is loaded */
+void mbc_map(GameBoy *gb);
+
+/* Write to the controller's registers at 0000-7FFF */
+void mbc_write(GameBoy *gb, WORD address, BYTE data);
+
+/* Access external RAM at A000-BFFF while its pages are not mapped, because it is disabled or, for
+   a write, because the page has not been written since it was last saved */
+BYTE mbc_read_ram(GameBoy *gb, WORD address);
+void mbc_write_ram(GameBoy *gb, WORD address, BYTE data);
+
+#endif
@@ -0,0 +1,37 @@
+#include <stddef.h>
+#include "gameboy.h"
+#include "memory_map.h"
+#include "mbc.h"
+
+void map_pages(BYTE **table, int first, int last, BYTE *memory) {
+    for (int page = first; page <= last; page++) {
+        table[page] = memory != NULL ? memory + (page - first) * PAGE_SIZE : NULL;
+    }
+}
+
+void memory_map_init(GameBoy *gb) {
+    map_pages(gb->memory_page, 0x00, 0xDF, gb->rom);
+    map_pages(gb->memory_page, 0xE0, 0xFD, &gb->rom[0xC000]);
+    map_pages(gb->memory_page, 0xFE, 0xFF, &gb->rom[0xFE00]);
+
+    map_pages(gb->read_page, 0x00, 0xDF, gb->rom);
+    map_pages(gb->read_page, 0xE0, 0xFD, &gb->rom[0xC000]); // Echo RAM
+    map_pages(gb->read_page, 0xFE, 0xFE, &gb->rom[0xFE00]); // OAM, see map_video_memory()
+    map_pages(gb->read_page, 0xFF, 0xFF, NULL);             // I/O registers have read handlers
+
+    map_pages(gb->write_page, 0x00, 0x7F, NULL);            // ROM and MBC control
+    map_pages(gb->write_page, 0x80, 0x9F, &gb->rom[0x8000]); // VRAM, see map_video_memory()
+    map_pages(gb->write_page, 0xA0, 0xDF, &gb->rom[0xA000]); // External and work RAM
+    map_pages(gb->write_page, 0xE0, 0xFD, &gb->rom[0xC000]); // Echo RAM
+    map_pages(gb->write_page, 0xFE, 0xFE, NULL);            // OAM, see map_video_memory()
+    map_pages(gb->write_page, 0xFF, 0xFF, NULL);            // I/O, High RAM and IE
+
+    map_video_memory(gb, gb->rom[0xFF41] & 0x03);
+    mbc_map(gb);
+}
+
+void map_video_memory(GameBoy *gb, unsigned int mode) {
+    map_pages(gb->write_page, 0x80, 0x9F, mode == 3 ? NULL : &gb->rom[0x8000]);
+    map_pages(gb->write_page, 0xFE, 0xFE, mode >= 2 || gb->dma_active ? NULL : &gb->rom[0xFE00]);
+    map_pages(gb->read_page, 0xFE, 0xFE, gb->dma_active ? NULL : &gb->rom[0xFE00]);
+}
@@ -0,0 +1,32 @@
+#ifndef MEMORY_MAP_H
+#define MEMORY_MAP_H
+#include "cpu.h"
+
+/* The memory map is split into 256 pages of 256 bytes. A page whose pointer is set is plain memory
+   and is read or written straight through the pointer. A NULL page has side effects, so accesses
+   to it go through the handlers in read_memory() and write_memory(). memory_page is never NULL: it
+   is the memory behind every page, whatever is mapped for reads and writes, and opcodes are fetched
+   through it. ROM and external RAM banks are mapped by mbc.c */
+#define PAGE_COUNT 0x100
+#define PAGE_SIZE 0x100
+
+/* The byte at address in the memory behind its page, without the side effects of a handler.
+   The address is used more than once, so it must not have side effects */
+#define MEMORY_AT(gb, address) ((gb)->memory_page[(WORD)(address) >> 8][(WORD)(address) & 0xFF])
+
+/* Echo RAM at E000-FDFF has no memory of its own, its pages point at the work RAM at C000-DDFF.
+   write_memory() folds echo addresses with this when an echo page has been switched to the handler */
+#define FOLD_ECHO(address) ((WORD)((address) - 0xE000) < 0x1E00 ? (WORD)((address) - 0x2000) : (WORD)(address))
+
+/* Point the pages from first to last of the table at consecutive pages of memory, or at NULL */
+void map_pages(BYTE **table, int first, int last, BYTE *memory);
+
+/* Point every page at its default memory and the selected cartridge banks. Called by cpu_init() */
+void memory_map_init(GameBoy *gb);
+
+/* VRAM cannot be written in mode 3 and OAM cannot be written in modes 2 and 3, or read or written
+   while a DMA transfer fills it. Called by set_stat_mode() and dma.c to switch those pages between
+   direct access and the handlers */
+void map_video_memory(GameBoy *gb, unsigned int mode);
+
+#endif
@@ -0,0 +1,523 @@
+/* Generated by gen_opcodes.py from opcodes.txt. Edit opcodes.txt instead of this file */
+#ifndef OPCODE_LIST_H
+#define OPCODE_LIST_H
+
+/* X(opcode, operand, cycles, name, statements) for every opcode, in order */
+#define MAIN_OPCODES(X) \
+    X(0x00, OPERAND_NONE, 4, "NOP", ) \
+    X(0x01, OPERAND_NN, 12, "LD BC,$%04X", gb->RegBC.data = read_nn(gb);) \
+    X(0x02, OPERAND_NONE, 8, "LD (BC),A", write_memory(gb, gb->RegBC.data, gb->RegAF.hi);) \
+    X(0x03, OPERAND_NONE, 8, "INC BC", gb->RegBC.data++;) \
+    X(0x04, OPERAND_NONE, 4, "INC B", gb->RegBC.hi = cpu_inc(gb, gb->RegBC.hi);) \
+    X(0x05, OPERAND_NONE, 4, "DEC B", gb->RegBC.hi = cpu_dec(gb, gb->RegBC.hi);) \
+    X(0x06, OPERAND_N, 8, "LD B,$%02X", gb->RegBC.hi = read_memory(gb, gb->PC++);) \
+    X(0x07, OPERAND_NONE, 4, "RLCA", cpu_rlca(gb);) \
+    X(0x08, OPERAND_NN, 20, "LD ($%04X),SP", cpu_loadRegSP(gb, read_nn(gb), &gb->RegSP);) \
+    X(0x09, OPERAND_NONE, 8, "ADD HL,BC", cpu_add16(gb, &gb->RegHL.data, &gb->RegBC.data);) \
+    X(0x0A, OPERAND_NONE, 8, "LD A,(BC)", gb->RegAF.hi = read_memory(gb, gb->RegBC.data);) \
+    X(0x0B, OPERAND_NONE, 8, "DEC BC", gb->RegBC.data--;) \
+    X(0x0C, OPERAND_NONE, 4, "INC C", gb->RegBC.lo = cpu_inc(gb, gb->RegBC.lo);) \
+    X(0x0D, OPERAND_NONE, 4, "DEC C", gb->RegBC.lo = cpu_dec(gb, gb->RegBC.lo);) \
+    X(0x0E, OPERAND_N, 8, "LD C,$%02X", gb->RegBC.lo = read_memory(gb, gb->PC++);) \
+    X(0x0F, OPERAND_NONE, 4, "RRCA", cpu_rrca(gb);) \
+    X(0x10, OPERAND_NONE, 4, "STOP", cpu_stop(gb);) \
+    X(0x11, OPERAND_NN, 12, "LD DE,$%04X", gb->RegDE.data = read_nn(gb);) \
+    X(0x12, OPERAND_NONE, 8, "LD (DE),A", write_memory(gb, gb->RegDE.data, gb->RegAF.hi);) \
+    X(0x13, OPERAND_NONE, 8, "INC DE", gb->RegDE.data++;) \
+    X(0x14, OPERAND_NONE, 4, "INC D", gb->RegDE.hi = cpu_inc(gb, gb->RegDE.hi);) \
+    X(0x15, OPERAND_NONE, 4, "DEC D", gb->RegDE.hi = cpu_dec(gb, gb->RegDE.hi);) \
+    X(0x16, OPERAND_N, 8, "LD D,$%02X", gb->RegDE.hi = read_memory(gb, gb->PC++);) \
+    X(0x17, OPERAND_NONE, 4, "RLA", cpu_rla(gb);) \
+    X(0x18, OPERAND_E, 12, "JR $%04X", cpu_jr(gb, NONE);) \
+    X(0x19, OPERAND_NONE, 8, "ADD HL,DE", cpu_add16(gb, &gb->RegHL.data, &gb->RegDE.data);) \
+    X(0x1A, OPERAND_NONE, 8, "LD A,(DE)", gb->RegAF.hi = read_memory(gb, gb->RegDE.data);) \
+    X(0x1B, OPERAND_NONE, 8, "DEC DE", gb->RegDE.data--;) \
+    X(0x1C, OPERAND_NONE, 4, "INC E", gb->RegDE.lo = cpu_inc(gb, gb->RegDE.lo);) \
+    X(0x1D, OPERAND_NONE, 4, "DEC E", gb->RegDE.lo = cpu_dec(gb, gb->RegDE.lo);) \
+    X(0x1E, OPERAND_N, 8, "LD E,$%02X", gb->RegDE.lo = read_memory(gb, gb->PC++);) \
+    X(0x1F, OPERAND_NONE, 4, "RRA", cpu_rra(gb);) \
+    X(0x20, OPERAND_E, 8, "JR NZ,$%04X", cpu_jr(gb, NZ);) \
+    X(0x21, OPERAND_NN, 12, "LD HL,$%04X", gb->RegHL.data = read_nn(gb);) \
+    X(0x22, OPERAND_NONE, 8, "LD (HL+),A", write_memory(gb, gb->RegHL.data, gb->RegAF.hi); gb->RegHL.data++;) \
+    X(0x23, OPERAND_NONE, 8, "INC HL", gb->RegHL.data++;) \
+    X(0x24, OPERAND_NONE, 4, "INC H", gb->RegHL.hi = cpu_inc(gb, gb->RegHL.hi);) \
+    X(0x25, OPERAND_NONE, 4, "DEC H", gb->RegHL.hi = cpu_dec(gb, gb->RegHL.hi);) \
+    X(0x26, OPERAND_N, 8, "LD H,$%02X", gb->RegHL.hi = read_memory(gb, gb->PC++);) \
+    X(0x27, OPERAND_NONE, 4, "DAA", cpu_daa(gb);) \
+    X(0x28, OPERAND_E, 8, "JR Z,$%04X", cpu_jr(gb, Z);) \
+    X(0x29, OPERAND_NONE, 8, "ADD HL,HL", cpu_add16(gb, &gb->RegHL.data, &gb->RegHL.data);) \
+    X(0x2A, OPERAND_NONE, 8, "LD A,(HL+)", gb->RegAF.hi = read_memory(gb, gb->RegHL.data); gb->RegHL.data++;) \
+    X(0x2B, OPERAND_NONE, 8, "DEC HL", gb->RegHL.data--;) \
+    X(0x2C, OPERAND_NONE, 4, "INC L", gb->RegHL.lo = cpu_inc(gb, gb->RegHL.lo);) \
+    X(0x2D, OPERAND_NONE, 4, "DEC L", gb->RegHL.lo = cpu_dec(gb, gb->RegHL.lo);) \
+    X(0x2E, OPERAND_N, 8, "LD L,$%02X", gb->RegHL.lo = read_memory(gb, gb->PC++);) \
+    X(0x2F, OPERAND_NONE, 4, "CPL", cpu_cpl(gb);) \
+    X(0x30, OPERAND_E, 8, "JR NC,$%04X", cpu_jr(gb, NC);) \
+    X(0x31, OPERAND_NN, 12, "LD SP,$%04X", gb->RegSP.data = read_nn(gb);) \
+    X(0x32, OPERAND_NONE, 8, "LD (HL-),A", write_memory(gb, gb->RegHL.data, gb->RegAF.hi); gb->RegHL.data--;) \
+    X(0x33, OPERAND_NONE, 8, "INC SP", gb->RegSP.data++;) \
+    X(0x34, OPERAND_NONE, 12, "INC (HL)", cpu_inc_hl(gb, gb->RegHL.data);) \
+    X(0x35, OPERAND_NONE, 12, "DEC (HL)", cpu_dec_hl(gb, gb->RegHL.data);) \
+    X(0x36, OPERAND_N, 12, "LD (HL),$%02X", BYTE n = read_memory(gb, gb->PC++); write_memory(gb, gb->RegHL.data, n);) \
+    X(0x37, OPERAND_NONE, 4, "SCF", cpu_scf(gb);) \
+    X(0x38, OPERAND_E, 8, "JR C,$%04X", cpu_jr(gb, C);) \
+    X(0x39, OPERAND_NONE, 8, "ADD HL,SP", cpu_add16(gb, &gb->RegHL.data, &gb->RegSP.data);) \
+    X(0x3A, OPERAND_NONE, 8, "LD A,(HL-)", gb->RegAF.hi = read_memory(gb, gb->RegHL.data); gb->RegHL.data--;) \
+    X(0x3B, OPERAND_NONE, 8, "DEC SP", gb->RegSP.data--;) \
+    X(0x3C, OPERAND_NONE, 4, "INC A", gb->RegAF.hi = cpu_inc(gb, gb->RegAF.hi);) \
+    X(0x3D, OPERAND_NONE, 4, "DEC A", gb->RegAF.hi = cpu_dec(gb, gb->RegAF.hi);) \
+    X(0x3E, OPERAND_N, 8, "LD A,$%02X", gb->RegAF.hi = read_memory(gb, gb->PC++);) \
+    X(0x3F, OPERAND_NONE, 4, "CCF", cpu_ccf(gb);) \
+    X(0x40, OPERAND_NONE, 4, "LD B,B", gb->RegBC.hi = gb->RegBC.hi;) \
+    X(0x41, OPERAND_NONE, 4, "LD B,C", gb->RegBC.hi = gb->RegBC.lo;) \
+    X(0x42, OPERAND_NONE, 4, "LD B,D", gb->RegBC.hi = gb->RegDE.hi;) \
+    X(0x43, OPERAND_NONE, 4, "LD B,E", gb->RegBC.hi = gb->RegDE.lo;) \
+    X(0x44, OPERAND_NONE, 4, "LD B,H", gb->RegBC.hi = gb->RegHL.hi;) \
+    X(0x45, OPERAND_NONE, 4, "LD B,L", gb->RegBC.hi = gb->RegHL.lo;) \
+    X(0x46, OPERAND_NONE, 8, "LD B,(HL)", gb->RegBC.hi = read_memory(gb, gb->RegHL.data);) \
+    X(0x47, OPERAND_NONE, 4, "LD B,A", gb->RegBC.hi = gb->RegAF.hi;) \
+    X(0x48, OPERAND_NONE, 4, "LD C,B", gb->RegBC.lo = gb->RegBC.hi;) \
+    X(0x49, OPERAND_NONE, 4, "LD C,C", gb->RegBC.lo = gb->RegBC.lo;) \
+    X(0x4A, OPERAND_NONE, 4, "LD C,D", gb->RegBC.lo = gb->RegDE.hi;) \
+    X(0x4B, OPERAND_NONE, 4, "LD C,E", gb->RegBC.lo = gb->RegDE.lo;) \
+    X(0x4C, OPERAND_NONE, 4, "LD C,H", gb->RegBC.lo = gb->RegHL.hi;) \
+    X(0x4D, OPERAND_NONE, 4, "LD C,L", gb->RegBC.lo = gb->RegHL.lo;) \
+    X(0x4E, OPERAND_NONE, 8, "LD C,(HL)", gb->RegBC.lo = read_memory(gb, gb->RegHL.data);) \
+    X(0x4F, OPERAND_NONE, 4, "LD C,A", gb->RegBC.lo = gb->RegAF.hi;) \
+    X(0x50, OPERAND_NONE, 4, "LD D,B", gb->RegDE.hi = gb->RegBC.hi;) \
+    X(0x51, OPERAND_NONE, 4, "LD D,C", gb->RegDE.hi = gb->RegBC.lo;) \
+    X(0x52, OPERAND_NONE, 4, "LD D,D", gb->RegDE.hi = gb->RegDE.hi;) \
+    X(0x53, OPERAND_NONE, 4, "LD D,E", gb->RegDE.hi = gb->RegDE.lo;) \
+    X(0x54, OPERAND_NONE, 4, "LD D,H", gb->RegDE.hi = gb->RegHL.hi;) \
+    X(0x55, OPERAND_NONE, 4, "LD D,L", gb->RegDE.hi = gb->RegHL.lo;) \
+    X(0x56, OPERAND_NONE, 8, "LD D,(HL)", gb->RegDE.hi = read_memory(gb, gb->RegHL.data);) \
+    X(0x57, OPERAND_NONE, 4, "LD D,A", gb->RegDE.hi = gb->RegAF.hi;) \
+    X(0x58, OPERAND_NONE, 4, "LD E,B", gb->RegDE.lo = gb->RegBC.hi;) \
+    X(0x59, OPERAND_NONE, 4, "LD E,C", gb->RegDE.lo = gb->RegBC.lo;) \
+    X(0x5A, OPERAND_NONE, 4, "LD E,D", gb->RegDE.lo = gb->RegDE.hi;) \
+    X(0x5B, OPERAND_NONE, 4, "LD E,E", gb->RegDE.lo = gb->RegDE.lo;) \
+    X(0x5C, OPERAND_NONE, 4, "LD E,H", gb->RegDE.lo = gb->RegHL.hi;) \
+    X(0x5D, OPERAND_NONE, 4, "LD E,L", gb->RegDE.lo = gb->RegHL.lo;) \
+    X(0x5E, OPERAND_NONE, 8, "LD E,(HL)", gb->RegDE.lo = read_memory(gb, gb->RegHL.data);) \
+    X(0x5F, OPERAND_NONE, 4, "LD E,A", gb->RegDE.lo = gb->RegAF.hi;) \
+    X(0x60, OPERAND_NONE, 4, "LD H,B", gb->RegHL.hi = gb->RegBC.hi;) \
+    X(0x61, OPERAND_NONE, 4, "LD H,C", gb->RegHL.hi = gb->RegBC.lo;) \
+    X(0x62, OPERAND_NONE, 4, "LD H,D", gb->RegHL.hi = gb->RegDE.hi;) \
+    X(0x63, OPERAND_NONE, 4, "LD H,E", gb->RegHL.hi = gb->RegDE.lo;) \
+    X(0x64, OPERAND_NONE, 4, "LD H,H", gb->RegHL.hi = gb->RegHL.hi;) \
+    X(0x65, OPERAND_NONE, 4, "LD H,L", gb->RegHL.hi = gb->RegHL.lo;) \
+    X(0x66, OPERAND_NONE, 8, "LD H,(HL)", gb->RegHL.hi = read_memory(gb, gb->RegHL.data);) \
+    X(0x67, OPERAND_NONE, 4, "LD H,A", gb->RegHL.hi = gb->RegAF.hi;) \
+    X(0x68, OPERAND_NONE, 4, "LD L,B", gb->RegHL.lo = gb->RegBC.hi;) \
+    X(0x69, OPERAND_NONE, 4, "LD L,C", gb->RegHL.lo = gb->RegBC.lo;) \
+    X(0x6A, OPERAND_NONE, 4, "LD L,D", gb->RegHL.lo = gb->RegDE.hi;) \
+    X(0x6B, OPERAND_NONE, 4, "LD L,E", gb->RegHL.lo = gb->RegDE.lo;) \
+    X(0x6C, OPERAND_NONE, 4, "LD L,H", gb->RegHL.lo = gb->RegHL.hi;) \
+    X(0x6D, OPERAND_NONE, 4, "LD L,L", gb->RegHL.lo = gb->RegHL.lo;) \
+    X(0x6E, OPERAND_NONE, 8, "LD L,(HL)", gb->RegHL.lo = read_memory(gb, gb->RegHL.data);) \
+    X(0x6F, OPERAND_NONE, 4, "LD L,A", gb->RegHL.lo = gb->RegAF.hi;) \
+    X(0x70, OPERAND_NONE, 8, "LD (HL),B", write_memory(gb, gb->RegHL.data, gb->RegBC.hi);) \
+    X(0x71, OPERAND_NONE, 8, "LD (HL),C", write_memory(gb, gb->RegHL.data, gb->RegBC.lo);) \
+    X(0x72, OPERAND_NONE, 8, "LD (HL),D", write_memory(gb, gb->RegHL.data, gb->RegDE.hi);) \
+    X(0x73, OPERAND_NONE, 8, "LD (HL),E", write_memory(gb, gb->RegHL.data, gb->RegDE.lo);) \
+    X(0x74, OPERAND_NONE, 8, "LD (HL),H", write_memory(gb, gb->RegHL.data, gb->RegHL.hi);) \
+    X(0x75, OPERAND_NONE, 8, "LD (HL),L", write_memory(gb, gb->RegHL.data, gb->RegHL.lo);) \
+    X(0x76, OPERAND_NONE, 4, "HALT", cpu_halt(gb);) \
+    X(0x77, OPERAND_NONE, 8, "LD (HL),A", write_memory(gb, gb->RegHL.data, gb->RegAF.hi);) \
+    X(0x78, OPERAND_NONE, 4, "LD A,B", gb->RegAF.hi = gb->RegBC.hi;) \
+    X(0x79, OPERAND_NONE, 4, "LD A,C", gb->RegAF.hi = gb->RegBC.lo;) \
+    X(0x7A, OPERAND_NONE, 4, "LD A,D", gb->RegAF.hi = gb->RegDE.hi;) \
+    X(0x7B, OPERAND_NONE, 4, "LD A,E", gb->RegAF.hi = gb->RegDE.lo;) \
+    X(0x7C, OPERAND_NONE, 4, "LD A,H", gb->RegAF.hi = gb->RegHL.hi;) \
+    X(0x7D, OPERAND_NONE, 4, "LD A,L", gb->RegAF.hi = gb->RegHL.lo;) \
+    X(0x7E, OPERAND_NONE, 8, "LD A,(HL)", gb->RegAF.hi = read_memory(gb, gb->RegHL.data);) \
+    X(0x7F, OPERAND_NONE, 4, "LD A,A", gb->RegAF.hi = gb->RegAF.hi;) \
+    X(0x80, OPERAND_NONE, 4, "ADD A,B", cpu_add(gb, gb->RegBC.hi);) \
+    X(0x81, OPERAND_NONE, 4, "ADD A,C", cpu_add(gb, gb->RegBC.lo);) \
+    X(0x82, OPERAND_NONE, 4, "ADD A,D", cpu_add(gb, gb->RegDE.hi);) \
+    X(0x83, OPERAND_NONE, 4, "ADD A,E", cpu_add(gb, gb->RegDE.lo);) \
+    X(0x84, OPERAND_NONE, 4, "ADD A,H", cpu_add(gb, gb->RegHL.hi);) \
+    X(0x85, OPERAND_NONE, 4, "ADD A,L", cpu_add(gb, gb->RegHL.lo);) \
+    X(0x86, OPERAND_NONE, 8, "ADD A,(HL)", cpu_add(gb, read_memory(gb, gb->RegHL.data));) \
+    X(0x87, OPERAND_NONE, 4, "ADD A,A", cpu_add(gb, gb->RegAF.hi);) \
+    X(0x88, OPERAND_NONE, 4, "ADC A,B", cpu_adc(gb, gb->RegBC.hi);) \
+    X(0x89, OPERAND_NONE, 4, "ADC A,C", cpu_adc(gb, gb->RegBC.lo);) \
+    X(0x8A, OPERAND_NONE, 4, "ADC A,D", cpu_adc(gb, gb->RegDE.hi);) \
+    X(0x8B, OPERAND_NONE, 4, "ADC A,E", cpu_adc(gb, gb->RegDE.lo);) \
+    X(0x8C, OPERAND_NONE, 4, "ADC A,H", cpu_adc(gb, gb->RegHL.hi);) \
+    X(0x8D, OPERAND_NONE, 4, "ADC A,L", cpu_adc(gb, gb->RegHL.lo);) \
+    X(0x8E, OPERAND_NONE, 8, "ADC A,(HL)", cpu_adc(gb, read_memory(gb, gb->RegHL.data));) \
+    X(0x8F, OPERAND_NONE, 4, "ADC A,A", cpu_adc(gb, gb->RegAF.hi);) \
+    X(0x90, OPERAND_NONE, 4, "SUB B", cpu_sub(gb, gb->RegBC.hi);) \
+    X(0x91, OPERAND_NONE, 4, "SUB C", cpu_sub(gb, gb->RegBC.lo);) \
+    X(0x92, OPERAND_NONE, 4, "SUB D", cpu_sub(gb, gb->RegDE.hi);) \
+    X(0x93, OPERAND_NONE, 4, "SUB E", cpu_sub(gb, gb->RegDE.lo);) \
+    X(0x94, OPERAND_NONE, 4, "SUB H", cpu_sub(gb, gb->RegHL.hi);) \
+    X(0x95, OPERAND_NONE, 4, "SUB L", cpu_sub(gb, gb->RegHL.lo);) \
+    X(0x96, OPERAND_NONE, 8, "SUB (HL)", cpu_sub(gb, read_memory(gb, gb->RegHL.data));) \
+    X(0x97, OPERAND_NONE, 4, "SUB A", cpu_sub(gb, gb->RegAF.hi);) \
+    X(0x98, OPERAND_NONE, 4, "SBC A,B", cpu_sbc(gb, gb->RegBC.hi);) \
+    X(0x99, OPERAND_NONE, 4, "SBC A,C", cpu_sbc(gb, gb->RegBC.lo);) \
+    X(0x9A, OPERAND_NONE, 4, "SBC A,D", cpu_sbc(gb, gb->RegDE.hi);) \
+    X(0x9B, OPERAND_NONE, 4, "SBC A,E", cpu_sbc(gb, gb->RegDE.lo);) \
+    X(0x9C, OPERAND_NONE, 4, "SBC A,H", cpu_sbc(gb, gb->RegHL.hi);) \
+    X(0x9D, OPERAND_NONE, 4, "SBC A,L", cpu_sbc(gb, gb->RegHL.lo);) \
+    X(0x9E, OPERAND_NONE, 8, "SBC A,(HL)", cpu_sbc(gb, read_memory(gb, gb->RegHL.data));) \
+    X(0x9F, OPERAND_NONE, 4, "SBC A,A", cpu_sbc(gb, gb->RegAF.hi);) \
+    X(0xA0, OPERAND_NONE, 4, "AND B", cpu_and(gb, gb->RegBC.hi);) \
+    X(0xA1, OPERAND_NONE, 4, "AND C", cpu_and(gb, gb->RegBC.lo);) \
+    X(0xA2, OPERAND_NONE, 4, "AND D", cpu_and(gb, gb->RegDE.hi);) \
+    X(0xA3, OPERAND_NONE, 4, "AND E", cpu_and(gb, gb->RegDE.lo);) \
+    X(0xA4, OPERAND_NONE, 4, "AND H", cpu_and(gb, gb->RegHL.hi);) \
+    X(0xA5, OPERAND_NONE, 4, "AND L", cpu_and(gb, gb->RegHL.lo);) \
+    X(0xA6, OPERAND_NONE, 8, "AND (HL)", cpu_and(gb, read_memory(gb, gb->RegHL.data));) \
+    X(0xA7, OPERAND_NONE, 4, "AND A", cpu_and(gb, gb->RegAF.hi);) \
+    X(0xA8, OPERAND_NONE, 4, "XOR B", cpu_xor(gb, gb->RegBC.hi);) \
+    X(0xA9, OPERAND_NONE, 4, "XOR C", cpu_xor(gb, gb->RegBC.lo);) \
+    X(0xAA, OPERAND_NONE, 4, "XOR D", cpu_xor(gb, gb->RegDE.hi);) \
+    X(0xAB, OPERAND_NONE, 4, "XOR E", cpu_xor(gb, gb->RegDE.lo);) \
+    X(0xAC, OPERAND_NONE, 4, "XOR H", cpu_xor(gb, gb->RegHL.hi);) \
+    X(0xAD, OPERAND_NONE, 4, "XOR L", cpu_xor(gb, gb->RegHL.lo);) \
+    X(0xAE, OPERAND_NONE, 8, "XOR (HL)", cpu_xor(gb, read_memory(gb, gb->RegHL.data));) \
+    X(0xAF, OPERAND_NONE, 4, "XOR A", cpu_xor(gb, gb->RegAF.hi);) \
+    X(0xB0, OPERAND_NONE, 4, "OR B", cpu_or(gb, gb->RegBC.hi);) \
+    X(0xB1, OPERAND_NONE, 4, "OR C", cpu_or(gb, gb->RegBC.lo);) \
+    X(0xB2, OPERAND_NONE, 4, "OR D", cpu_or(gb, gb->RegDE.hi);) \
+    X(0xB3, OPERAND_NONE, 4, "OR E", cpu_or(gb, gb->RegDE.lo);) \
+    X(0xB4, OPERAND_NONE, 4, "OR H", cpu_or(gb, gb->RegHL.hi);) \
+    X(0xB5, OPERAND_NONE, 4, "OR L", cpu_or(gb, gb->RegHL.lo);) \
+    X(0xB6, OPERAND_NONE, 8, "OR (HL)", cpu_or(gb, read_memory(gb, gb->RegHL.data));) \
+    X(0xB7, OPERAND_NONE, 4, "OR A", cpu_or(gb, gb->RegAF.hi);) \
+    X(0xB8, OPERAND_NONE, 4, "CP B", cpu_cp(gb, gb->RegBC.hi);) \
+    X(0xB9, OPERAND_NONE, 4, "CP C", cpu_cp(gb, gb->RegBC.lo);) \
+    X(0xBA, OPERAND_NONE, 4, "CP D", cpu_cp(gb, gb->RegDE.hi);) \
+    X(0xBB, OPERAND_NONE, 4, "CP E", cpu_cp(gb, gb->RegDE.lo);) \
+    X(0xBC, OPERAND_NONE, 4, "CP H", cpu_cp(gb, gb->RegHL.hi);) \
+    X(0xBD, OPERAND_NONE, 4, "CP L", cpu_cp(gb, gb->RegHL.lo);) \
+    X(0xBE, OPERAND_NONE, 8, "CP (HL)", cpu_cp(gb, MEMORY_AT(gb, gb->RegHL.data));) \
+    X(0xBF, OPERAND_NONE, 4, "CP A", cpu_cp(gb, gb->RegAF.hi);) \
+    X(0xC0, OPERAND_NONE, 8, "RET NZ", cpu_ret(gb, NZ);) \
+    X(0xC1, OPERAND_NONE, 12, "POP BC", stack_pop(gb, &gb->RegBC.hi, &gb->RegBC.lo);) \
+    X(0xC2, OPERAND_NN, 12, "JP NZ,$%04X", cpu_jump(gb, NZ);) \
+    X(0xC3, OPERAND_NN, 12, "JP $%04X", cpu_jump(gb, NONE);) \
+    X(0xC4, OPERAND_NN, 12, "CALL NZ,$%04X", cpu_call(gb, NZ);) \
+    X(0xC5, OPERAND_NONE, 16, "PUSH BC", stack_push(gb, &gb->RegBC.hi, &gb->RegBC.lo);) \
+    X(0xC6, OPERAND_N, 8, "ADD A,$%02X", cpu_add(gb, read_memory(gb, gb->PC++));) \
+    X(0xC7, OPERAND_NONE, 32, "RST 00H", cpu_rst(gb, 0x00);) \
+    X(0xC8, OPERAND_NONE, 8, "RET Z", cpu_ret(gb, Z);) \
+    X(0xC9, OPERAND_NONE, 8, "RET", cpu_ret(gb, NONE);) \
+    X(0xCA, OPERAND_NN, 12, "JP Z,$%04X", cpu_jump(gb, Z);) \
+    X(0xCB, OPERAND_CB, 0, "PREFIX CB", return CB(gb);) \
+    X(0xCC, OPERAND_NN, 12, "CALL Z,$%04X", cpu_call(gb, Z);) \
+    X(0xCD, OPERAND_NN, 12, "CALL $%04X", cpu_call(gb, NONE);) \
+    X(0xCE, OPERAND_N, 8, "ADC A,$%02X", cpu_adc(gb, read_memory(gb, gb->PC++));) \
+    X(0xCF, OPERAND_NONE, 32, "RST 08H", cpu_rst(gb, 0x08);) \
+    X(0xD0, OPERAND_NONE, 8, "RET NC", cpu_ret(gb, NC);) \
+    X(0xD1, OPERAND_NONE, 12, "POP DE", stack_pop(gb, &gb->RegDE.hi, &gb->RegDE.lo);) \
+    X(0xD2, OPERAND_NN, 12, "JP NC,$%04X", cpu_jump(gb, NC);) \
+    X(0xD3, OPERAND_NONE, 0, "INVALID", ) \
+    X(0xD4, OPERAND_NN, 12, "CALL NC,$%04X", cpu_call(gb, NC);) \
+    X(0xD5, OPERAND_NONE, 16, "PUSH DE", stack_push(gb, &gb->RegDE.hi, &gb->RegDE.lo);) \
+    X(0xD6, OPERAND_N, 8, "SUB $%02X", cpu_sub(gb, read_memory(gb, gb->PC++));) \
+    X(0xD7, OPERAND_NONE, 32, "RST 10H", cpu_rst(gb, 0x10);) \
+    X(0xD8, OPERAND_NONE, 8, "RET C", cpu_ret(gb, C);) \
+    X(0xD9, OPERAND_NONE, 8, "RETI", cpu_reti(gb);) \
+    X(0xDA, OPERAND_NN, 12, "JP C,$%04X", cpu_jump(gb, C);) \
+    X(0xDB, OPERAND_NONE, 0, "INVALID", ) \
+    X(0xDC, OPERAND_NN, 12, "CALL C,$%04X", cpu_call(gb, C);) \
+    X(0xDD, OPERAND_NONE, 0, "INVALID", ) \
+    X(0xDE, OPERAND_N, 8, "SBC A,$%02X", cpu_sbc(gb, read_memory(gb, gb->PC++));) \
+    X(0xDF, OPERAND_NONE, 32, "RST 18H", cpu_rst(gb, 0x18);) \
+    X(0xE0, OPERAND_N, 12, "LDH ($%02X),A", BYTE n = read_memory(gb, gb->PC++); write_memory(gb, 0xFF00 + n, gb->RegAF.hi);) \
+    X(0xE1, OPERAND_NONE, 12, "POP HL", stack_pop(gb, &gb->RegHL.hi, &gb->RegHL.lo);) \
+    X(0xE2, OPERAND_NONE, 8, "LD (C),A", write_memory(gb, 0xFF00 + gb->RegBC.lo, gb->RegAF.hi);) \
+    X(0xE3, OPERAND_NONE, 0, "INVALID", ) \
+    X(0xE4, OPERAND_NONE, 0, "INVALID", ) \
+    X(0xE5, OPERAND_NONE, 16, "PUSH HL", stack_push(gb, &gb->RegHL.hi, &gb->RegHL.lo);) \
+    X(0xE6, OPERAND_N, 8, "AND $%02X", cpu_and(gb, read_memory(gb, gb->PC++));) \
+    X(0xE7, OPERAND_NONE, 32, "RST 20H", cpu_rst(gb, 0x20);) \
+    X(0xE8, OPERAND_N, 16, "ADD SP,$%02X", cpu_add_sp_n(gb);) \
+    X(0xE9, OPERAND_NONE, 4, "JP (HL)", gb->PC = gb->RegHL.data;) \
+    X(0xEA, OPERAND_NN, 16, "LD ($%04X),A", write_memory(gb, read_nn(gb), gb->RegAF.hi);) \
+    X(0xEB, OPERAND_NONE, 0, "INVALID", ) \
+    X(0xEC, OPERAND_NONE, 0, "INVALID", ) \
+    X(0xED, OPERAND_NONE, 0, "INVALID", ) \
+    X(0xEE, OPERAND_N, 8, "XOR $%02X", cpu_xor(gb, read_memory(gb, gb->PC++));) \
+    X(0xEF, OPERAND_NONE, 32, "RST 28H", cpu_rst(gb, 0x28);) \
+    X(0xF0, OPERAND_N, 12, "LDH A,($%02X)", BYTE n = read_memory(gb, gb->PC++); gb->RegAF.hi = read_memory(gb, 0xFF00 + n);) \
+    X(0xF1, OPERAND_NONE, 12, "POP AF", stack_pop(gb, &gb->RegAF.hi, &gb->RegAF.lo);) \
+    X(0xF2, OPERAND_NONE, 8, "LD A,(C)", gb->RegAF.hi = read_memory(gb, 0xFF00 + gb->RegBC.lo);) \
+    X(0xF3, OPERAND_NONE, 4, "DI", cpu_ei(gb, 0);) \
+    X(0xF4, OPERAND_NONE, 0, "INVALID", ) \
+    X(0xF5, OPERAND_NONE, 16, "PUSH AF", stack_push(gb, &gb->RegAF.hi, &gb->RegAF.lo);) \
+    X(0xF6, OPERAND_N, 8, "OR $%02X", cpu_or(gb, read_memory(gb, gb->PC++));) \
+    X(0xF7, OPERAND_NONE, 32, "RST 30H", cpu_rst(gb, 0x30);) \
+    X(0xF8, OPERAND_N, 12, "LD HL,SP+$%02X", LDHL_SP_n(gb);) \
+    X(0xF9, OPERAND_NONE, 8, "LD SP,HL", gb->RegSP.data = gb->RegHL.data;) \
+    X(0xFA, OPERAND_NN, 16, "LD A,($%04X)", gb->RegAF.hi = read_memory(gb, read_nn(gb));) \
+    X(0xFB, OPERAND_NONE, 4, "EI", cpu_ei(gb, 1);) \
+    X(0xFC, OPERAND_NONE, 0, "INVALID", ) \
+    X(0xFD, OPERAND_NONE, 0, "INVALID", ) \
+    X(0xFE, OPERAND_N, 8, "CP $%02X", cpu_cp(gb, read_memory(gb, gb->PC++));) \
+    X(0xFF, OPERAND_NONE, 32, "RST 38H", cpu_rst(gb, 0x38);)
+
+/* The same for the opcodes after the 0xCB prefix */
+#define CB_OPCODES(X) \
+    X(0x00, OPERAND_NONE, 8, "RLC B", cpu_rlc(gb, &gb->RegBC.hi);) \
+    X(0x01, OPERAND_NONE, 8, "RLC C", cpu_rlc(gb, &gb->RegBC.lo);) \
+    X(0x02, OPERAND_NONE, 8, "RLC D", cpu_rlc(gb, &gb->RegDE.hi);) \
+    X(0x03, OPERAND_NONE, 8, "RLC E", cpu_rlc(gb, &gb->RegDE.lo);) \
+    X(0x04, OPERAND_NONE, 8, "RLC H", cpu_rlc(gb, &gb->RegHL.hi);) \
+    X(0x05, OPERAND_NONE, 8, "RLC L", cpu_rlc(gb, &gb->RegHL.lo);) \
+    X(0x06, OPERAND_NONE, 16, "RLC (HL)", cpu_rlc_hl(gb, gb->RegHL.data);) \
+    X(0x07, OPERAND_NONE, 8, "RLC A", cpu_rlc(gb, &gb->RegAF.hi);) \
+    X(0x08, OPERAND_NONE, 8, "RRC B", cpu_rrc(gb, &gb->RegBC.hi);) \
+    X(0x09, OPERAND_NONE, 8, "RRC C", cpu_rrc(gb, &gb->RegBC.lo);) \
+    X(0x0A, OPERAND_NONE, 8, "RRC D", cpu_rrc(gb, &gb->RegDE.hi);) \
+    X(0x0B, OPERAND_NONE, 8, "RRC E", cpu_rrc(gb, &gb->RegDE.lo);) \
+    X(0x0C, OPERAND_NONE, 8, "RRC H", cpu_rrc(gb, &gb->RegHL.hi);) \
+    X(0x0D, OPERAND_NONE, 8, "RRC L", cpu_rrc(gb, &gb->RegHL.lo);) \
+    X(0x0E, OPERAND_NONE, 16, "RRC (HL)", cpu_rrc_hl(gb, gb->RegHL.data);) \
+    X(0x0F, OPERAND_NONE, 8, "RRC A", cpu_rrc(gb, &gb->RegAF.hi);) \
+    X(0x10, OPERAND_NONE, 8, "RL B", cpu_rl(gb, &gb->RegBC.hi);) \
+    X(0x11, OPERAND_NONE, 8, "RL C", cpu_rl(gb, &gb->RegBC.lo);) \
+    X(0x12, OPERAND_NONE, 8, "RL D", cpu_rl(gb, &gb->RegDE.hi);) \
+    X(0x13, OPERAND_NONE, 8, "RL E", cpu_rl(gb, &gb->RegDE.lo);) \
+    X(0x14, OPERAND_NONE, 8, "RL H", cpu_rl(gb, &gb->RegHL.hi);) \
+    X(0x15, OPERAND_NONE, 8, "RL L", cpu_rl(gb, &gb->RegHL.lo);) \
+    X(0x16, OPERAND_NONE, 16, "RL (HL)", cpu_rl_hl(gb, gb->RegHL.data);) \
+    X(0x17, OPERAND_NONE, 8, "RL A", cpu_rl(gb, &gb->RegAF.hi);) \
+    X(0x18, OPERAND_NONE, 8, "RR B", cpu_rr(gb, &gb->RegBC.hi);) \
+    X(0x19, OPERAND_NONE, 8, "RR C", cpu_rr(gb, &gb->RegBC.lo);) \
+    X(0x1A, OPERAND_NONE, 8, "RR D", cpu_rr(gb, &gb->RegDE.hi);) \
+    X(0x1B, OPERAND_NONE, 8, "RR E", cpu_rr(gb, &gb->RegDE.lo);) \
+    X(0x1C, OPERAND_NONE, 8, "RR H", cpu_rr(gb, &gb->RegHL.hi);) \
+    X(0x1D, OPERAND_NONE, 8, "RR L", cpu_rr(gb, &gb->RegHL.lo);) \
+    X(0x1E, OPERAND_NONE, 16, "RR (HL)", cpu_rr_hl(gb, gb->RegHL.data);) \
+    X(0x1F, OPERAND_NONE, 8, "RR A", cpu_rr(gb, &gb->RegAF.hi);) \
+    X(0x20, OPERAND_NONE, 8, "SLA B", cpu_sla(gb, &gb->RegBC.hi);) \
+    X(0x21, OPERAND_NONE, 8, "SLA C", cpu_sla(gb, &gb->RegBC.lo);) \
+    X(0x22, OPERAND_NONE, 8, "SLA D", cpu_sla(gb, &gb->RegDE.hi);) \
+    X(0x23, OPERAND_NONE, 8, "SLA E", cpu_sla(gb, &gb->RegDE.lo);) \
+    X(0x24, OPERAND_NONE, 8, "SLA H", cpu_sla(gb, &gb->RegHL.hi);) \
+    X(0x25, OPERAND_NONE, 8, "SLA L", cpu_sla(gb, &gb->RegHL.lo);) \
+    X(0x26, OPERAND_NONE, 16, "SLA (HL)", cpu_sla_hl(gb, gb->RegHL.data);) \
+    X(0x27, OPERAND_NONE, 8, "SLA A", cpu_sla(gb, &gb->RegAF.hi);) \
+    X(0x28, OPERAND_NONE, 8, "SRA B", cpu_sra(gb, &gb->RegBC.hi);) \
+    X(0x29, OPERAND_NONE, 8, "SRA C", cpu_sra(gb, &gb->RegBC.lo);) \
+    X(0x2A, OPERAND_NONE, 8, "SRA D", cpu_sra(gb, &gb->RegDE.hi);) \
+    X(0x2B, OPERAND_NONE, 8, "SRA E", cpu_sra(gb, &gb->RegDE.lo);) \
+    X(0x2C, OPERAND_NONE, 8, "SRA H", cpu_sra(gb, &gb->RegHL.hi);) \
+    X(0x2D, OPERAND_NONE, 8, "SRA L", cpu_sra(gb, &gb->RegHL.lo);) \
+    X(0x2E, OPERAND_NONE, 16, "SRA (HL)", cpu_sra_hl(gb, gb->RegHL.data);) \
+    X(0x2F, OPERAND_NONE, 8, "SRA A", cpu_sra(gb, &gb->RegAF.hi);) \
+    X(0x30, OPERAND_NONE, 8, "SWAP B", cpu_swap(gb, &gb->RegBC.hi);) \
+    X(0x31, OPERAND_NONE, 8, "SWAP C", cpu_swap(gb, &gb->RegBC.lo);) \
+    X(0x32, OPERAND_NONE, 8, "SWAP D", cpu_swap(gb, &gb->RegDE.hi);) \
+    X(0x33, OPERAND_NONE, 8, "SWAP E", cpu_swap(gb, &gb->RegDE.lo);) \
+    X(0x34, OPERAND_NONE, 8, "SWAP H", cpu_swap(gb, &gb->RegHL.hi);) \
+    X(0x35, OPERAND_NONE, 8, "SWAP L", cpu_swap(gb, &gb->RegHL.lo);) \
+    X(0x36, OPERAND_NONE, 16, "SWAP (HL)", cpu_swap_hl(gb, gb->RegHL.data);) \
+    X(0x37, OPERAND_NONE, 8, "SWAP A", cpu_swap(gb, &gb->RegAF.hi);) \
+    X(0x38, OPERAND_NONE, 8, "SRL B", cpu_srl(gb, &gb->RegBC.hi);) \
+    X(0x39, OPERAND_NONE, 8, "SRL C", cpu_srl(gb, &gb->RegBC.lo);) \
+    X(0x3A, OPERAND_NONE, 8, "SRL D", cpu_srl(gb, &gb->RegDE.hi);) \
+    X(0x3B, OPERAND_NONE, 8, "SRL E", cpu_srl(gb, &gb->RegDE.lo);) \
+    X(0x3C, OPERAND_NONE, 8, "SRL H", cpu_srl(gb, &gb->RegHL.hi);) \
+    X(0x3D, OPERAND_NONE, 8, "SRL L", cpu_srl(gb, &gb->RegHL.lo);) \
+    X(0x3E, OPERAND_NONE, 16, "SRL (HL)", cpu_srl_hl(gb, gb->RegHL.data);) \
+    X(0x3F, OPERAND_NONE, 8, "SRL A", cpu_srl(gb, &gb->RegAF.hi);) \
+    X(0x40, OPERAND_NONE, 8, "BIT 0,B", cpu_test_bit(gb, 0, &gb->RegBC.hi);) \
+    X(0x41, OPERAND_NONE, 8, "BIT 0,C", cpu_test_bit(gb, 0, &gb->RegBC.lo);) \
+    X(0x42, OPERAND_NONE, 8, "BIT 0,D", cpu_test_bit(gb, 0, &gb->RegDE.hi);) \
+    X(0x43, OPERAND_NONE, 8, "BIT 0,E", cpu_test_bit(gb, 0, &gb->RegDE.lo);) \
+    X(0x44, OPERAND_NONE, 8, "BIT 0,H", cpu_test_bit(gb, 0, &gb->RegHL.hi);) \
+    X(0x45, OPERAND_NONE, 8, "BIT 0,L", cpu_test_bit(gb, 0, &gb->RegHL.lo);) \
+    X(0x46, OPERAND_NONE, 16, "BIT 0,(HL)", BYTE n = read_memory(gb, gb->RegHL.data); cpu_test_bit(gb, 0, &n);) \
+    X(0x47, OPERAND_NONE, 8, "BIT 0,A", cpu_test_bit(gb, 0, &gb->RegAF.hi);) \
+    X(0x48, OPERAND_NONE, 8, "BIT 1,B", cpu_test_bit(gb, 1, &gb->RegBC.hi);) \
+    X(0x49, OPERAND_NONE, 8, "BIT 1,C", cpu_test_bit(gb, 1, &gb->RegBC.lo);) \
+    X(0x4A, OPERAND_NONE, 8, "BIT 1,D", cpu_test_bit(gb, 1, &gb->RegDE.hi);) \
+    X(0x4B, OPERAND_NONE, 8, "BIT 1,E", cpu_test_bit(gb, 1, &gb->RegDE.lo);) \
+    X(0x4C, OPERAND_NONE, 8, "BIT 1,H", cpu_test_bit(gb, 1, &gb->RegHL.hi);) \
+    X(0x4D, OPERAND_NONE, 8, "BIT 1,L", cpu_test_bit(gb, 1, &gb->RegHL.lo);) \
+    X(0x4E, OPERAND_NONE, 16, "BIT 1,(HL)", BYTE n = read_memory(gb, gb->RegHL.data); cpu_test_bit(gb, 1, &n);) \
+    X(0x4F, OPERAND_NONE, 8, "BIT 1,A", cpu_test_bit(gb, 1, &gb->RegAF.hi);) \
+    X(0x50, OPERAND_NONE, 8, "BIT 2,B", cpu_test_bit(gb, 2, &gb->RegBC.hi);) \
+    X(0x51, OPERAND_NONE, 8, "BIT 2,C", cpu_test_bit(gb, 2, &gb->RegBC.lo);) \
+    X(0x52, OPERAND_NONE, 8, "BIT 2,D", cpu_test_bit(gb, 2, &gb->RegDE.hi);) \
+    X(0x53, OPERAND_NONE, 8, "BIT 2,E", cpu_test_bit(gb, 2, &gb->RegDE.lo);) \
+    X(0x54, OPERAND_NONE, 8, "BIT 2,H", cpu_test_bit(gb, 2, &gb->RegHL.hi);) \
+    X(0x55, OPERAND_NONE, 8, "BIT 2,L", cpu_test_bit(gb, 2, &gb->RegHL.lo);) \
+    X(0x56, OPERAND_NONE, 16, "BIT 2,(HL)", BYTE n = read_memory(gb, gb->RegHL.data); cpu_test_bit(gb, 2, &n);) \
+    X(0x57, OPERAND_NONE, 8, "BIT 2,A", cpu_test_bit(gb, 2, &gb->RegAF.hi);) \
+    X(0x58, OPERAND_NONE, 8, "BIT 3,B", cpu_test_bit(gb, 3, &gb->RegBC.hi);) \
+    X(0x59, OPERAND_NONE, 8, "BIT 3,C", cpu_test_bit(gb, 3, &gb->RegBC.lo);) \
+    X(0x5A, OPERAND_NONE, 8, "BIT 3,D", cpu_test_bit(gb, 3, &gb->RegDE.hi);) \
+    X(0x5B, OPERAND_NONE, 8, "BIT 3,E", cpu_test_bit(gb, 3, &gb->RegDE.lo);) \
+    X(0x5C, OPERAND_NONE, 8, "BIT 3,H", cpu_test_bit(gb, 3, &gb->RegHL.hi);) \
+    X(0x5D, OPERAND_NONE, 8, "BIT 3,L", cpu_test_bit(gb, 3, &gb->RegHL.lo);) \
+    X(0x5E, OPERAND_NONE, 16, "BIT 3,(HL)", BYTE n = read_memory(gb, gb->RegHL.data); cpu_test_bit(gb, 3, &n);) \
+    X(0x5F, OPERAND_NONE, 8, "BIT 3,A", cpu_test_bit(gb, 3, &gb->RegAF.hi);) \
+    X(0x60, OPERAND_NONE, 8, "BIT 4,B", cpu_test_bit(gb, 4, &gb->RegBC.hi);) \
+    X(0x61, OPERAND_NONE, 8, "BIT 4,C", cpu_test_bit(gb, 4, &gb->RegBC.lo);) \
+    X(0x62, OPERAND_NONE, 8, "BIT 4,D", cpu_test_bit(gb, 4, &gb->RegDE.hi);) \
+    X(0x63, OPERAND_NONE, 8, "BIT 4,E", cpu_test_bit(gb, 4, &gb->RegDE.lo);) \
+    X(0x64, OPERAND_NONE, 8, "BIT 4,H", cpu_test_bit(gb, 4, &gb->RegHL.hi);) \
+    X(0x65, OPERAND_NONE, 8, "BIT 4,L", cpu_test_bit(gb, 4, &gb->RegHL.lo);) \
+    X(0x66, OPERAND_NONE, 16, "BIT 4,(HL)", BYTE n = read_memory(gb, gb->RegHL.data); cpu_test_bit(gb, 4, &n);) \
+    X(0x67, OPERAND_NONE, 8, "BIT 4,A", cpu_test_bit(gb, 4, &gb->RegAF.hi);) \
+    X(0x68, OPERAND_NONE, 8, "BIT 5,B", cpu_test_bit(gb, 5, &gb->RegBC.hi);) \
+    X(0x69, OPERAND_NONE, 8, "BIT 5,C", cpu_test_bit(gb, 5, &gb->RegBC.lo);) \
+    X(0x6A, OPERAND_NONE, 8, "BIT 5,D", cpu_test_bit(gb, 5, &gb->RegDE.hi);) \
+    X(0x6B, OPERAND_NONE, 8, "BIT 5,E", cpu_test_bit(gb, 5, &gb->RegDE.lo);) \
+    X(0x6C, OPERAND_NONE, 8, "BIT 5,H", cpu_test_bit(gb, 5, &gb->RegHL.hi);) \
+    X(0x6D, OPERAND_NONE, 8, "BIT 5,L", cpu_test_bit(gb, 5, &gb->RegHL.lo);) \
+    X(0x6E, OPERAND_NONE, 16, "BIT 5,(HL)", BYTE n = read_memory(gb, gb->RegHL.data); cpu_test_bit(gb, 5, &n);) \
+    X(0x6F, OPERAND_NONE, 8, "BIT 5,A", cpu_test_bit(gb, 5, &gb->RegAF.hi);) \
+    X(0x70, OPERAND_NONE, 8, "BIT 6,B", cpu_test_bit(gb, 6, &gb->RegBC.hi);) \
+    X(0x71, OPERAND_NONE, 8, "BIT 6,C", cpu_test_bit(gb, 6, &gb->RegBC.lo);) \
+    X(0x72, OPERAND_NONE, 8, "BIT 6,D", cpu_test_bit(gb, 6, &gb->RegDE.hi);) \
+    X(0x73, OPERAND_NONE, 8, "BIT 6,E", cpu_test_bit(gb, 6, &gb->RegDE.lo);) \
+    X(0x74, OPERAND_NONE, 8, "BIT 6,H", cpu_test_bit(gb, 6, &gb->RegHL.hi);) \
+    X(0x75, OPERAND_NONE, 8, "BIT 6,L", cpu_test_bit(gb, 6, &gb->RegHL.lo);) \
+    X(0x76, OPERAND_NONE, 16, "BIT 6,(HL)", BYTE n = read_memory(gb, gb->RegHL.data); cpu_test_bit(gb, 6, &n);) \
+    X(0x77, OPERAND_NONE, 8, "BIT 6,A", cpu_test_bit(gb, 6, &gb->RegAF.hi);) \
+    X(0x78, OPERAND_NONE, 8, "BIT 7,B", cpu_test_bit(gb, 7, &gb->RegBC.hi);) \
+    X(0x79, OPERAND_NONE, 8, "BIT 7,C", cpu_test_bit(gb, 7, &gb->RegBC.lo);) \
+    X(0x7A, OPERAND_NONE, 8, "BIT 7,D", cpu_test_bit(gb, 7, &gb->RegDE.hi);) \
+    X(0x7B, OPERAND_NONE, 8, "BIT 7,E", cpu_test_bit(gb, 7, &gb->RegDE.lo);) \
+    X(0x7C, OPERAND_NONE, 8, "BIT 7,H", cpu_test_bit(gb, 7, &gb->RegHL.hi);) \
+    X(0x7D, OPERAND_NONE, 8, "BIT 7,L", cpu_test_bit(gb, 7, &gb->RegHL.lo);) \
+    X(0x7E, OPERAND_NONE, 16, "BIT 7,(HL)", BYTE n = read_memory(gb, gb->RegHL.data); cpu_test_bit(gb, 7, &n);) \
+    X(0x7F, OPERAND_NONE, 8, "BIT 7,A", cpu_test_bit(gb, 7, &gb->RegAF.hi);) \
+    X(0x80, OPERAND_NONE, 8, "RES 0,B", cpu_reset_bit(0, &gb->RegBC.hi);) \
+    X(0x81, OPERAND_NONE, 8, "RES 0,C", cpu_reset_bit(0, &gb->RegBC.lo);) \
+    X(0x82, OPERAND_NONE, 8, "RES 0,D", cpu_reset_bit(0, &gb->RegDE.hi);) \
+    X(0x83, OPERAND_NONE, 8, "RES 0,E", cpu_reset_bit(0, &gb->RegDE.lo);) \
+    X(0x84, OPERAND_NONE, 8, "RES 0,H", cpu_reset_bit(0, &gb->RegHL.hi);) \
+    X(0x85, OPERAND_NONE, 8, "RES 0,L", cpu_reset_bit(0, &gb->RegHL.lo);) \
+    X(0x86, OPERAND_NONE, 16, "RES 0,(HL)", cpu_reset_bit_hl(gb, 0, gb->RegHL.data);) \
+    X(0x87, OPERAND_NONE, 8, "RES 0,A", cpu_reset_bit(0, &gb->RegAF.hi);) \
+    X(0x88, OPERAND_NONE, 8, "RES 1,B", cpu_reset_bit(1, &gb->RegBC.hi);) \
+    X(0x89, OPERAND_NONE, 8, "RES 1,C", cpu_reset_bit(1, &gb->RegBC.lo);) \
+    X(0x8A, OPERAND_NONE, 8, "RES 1,D", cpu_reset_bit(1, &gb->RegDE.hi);) \
+    X(0x8B, OPERAND_NONE, 8, "RES 1,E", cpu_reset_bit(1, &gb->RegDE.lo);) \
+    X(0x8C, OPERAND_NONE, 8, "RES 1,H", cpu_reset_bit(1, &gb->RegHL.hi);) \
+    X(0x8D, OPERAND_NONE, 8, "RES 1,L", cpu_reset_bit(1, &gb->RegHL.lo);) \
+    X(0x8E, OPERAND_NONE, 16, "RES 1,(HL)", cpu_reset_bit_hl(gb, 1, gb->RegHL.data);) \
+    X(0x8F, OPERAND_NONE, 8, "RES 1,A", cpu_reset_bit(1, &gb->RegAF.hi);) \
+    X(0x90, OPERAND_NONE, 8, "RES 2,B", cpu_reset_bit(2, &gb->RegBC.hi);) \
+    X(0x91, OPERAND_NONE, 8, "RES 2,C", cpu_reset_bit(2, &gb->RegBC.lo);) \
+    X(0x92, OPERAND_NONE, 8, "RES 2,D", cpu_reset_bit(2, &gb->RegDE.hi);) \
+    X(0x93, OPERAND_NONE, 8, "RES 2,E", cpu_reset_bit(2, &gb->RegDE.lo);) \
+    X(0x94, OPERAND_NONE, 8, "RES 2,H", cpu_reset_bit(2, &gb->RegHL.hi);) \
+    X(0x95, OPERAND_NONE, 8, "RES 2,L", cpu_reset_bit(2, &gb->RegHL.lo);) \
+    X(0x96, OPERAND_NONE, 16, "RES 2,(HL)", cpu_reset_bit_hl(gb, 2, gb->RegHL.data);) \
+    X(0x97, OPERAND_NONE, 8, "RES 2,A", cpu_reset_bit(2, &gb->RegAF.hi);) \
+    X(0x98, OPERAND_NONE, 8, "RES 3,B", cpu_reset_bit(3, &gb->RegBC.hi);) \
+    X(0x99, OPERAND_NONE, 8, "RES 3,C", cpu_reset_bit(3, &gb->RegBC.lo);) \
+    X(0x9A, OPERAND_NONE, 8, "RES 3,D", cpu_reset_bit(3, &gb->RegDE.hi);) \
+    X(0x9B, OPERAND_NONE, 8, "RES 3,E", cpu_reset_bit(3, &gb->RegDE.lo);) \
+    X(0x9C, OPERAND_NONE, 8, "RES 3,H", cpu_reset_bit(3, &gb->RegHL.hi);) \
+    X(0x9D, OPERAND_NONE, 8, "RES 3,L", cpu_reset_bit(3, &gb->RegHL.lo);) \
+    X(0x9E, OPERAND_NONE, 16, "RES 3,(HL)", cpu_reset_bit_hl(gb, 3, gb->RegHL.data);) \
+    X(0x9F, OPERAND_NONE, 8, "RES 3,A", cpu_reset_bit(3, &gb->RegAF.hi);) \
+    X(0xA0, OPERAND_NONE, 8, "RES 4,B", cpu_reset_bit(4, &gb->RegBC.hi);) \
+    X(0xA1, OPERAND_NONE, 8, "RES 4,C", cpu_reset_bit(4, &gb->RegBC.lo);) \
+    X(0xA2, OPERAND_NONE, 8, "RES 4,D", cpu_reset_bit(4, &gb->RegDE.hi);) \
+    X(0xA3, OPERAND_NONE, 8, "RES 4,E", cpu_reset_bit(4, &gb->RegDE.lo);) \
+    X(0xA4, OPERAND_NONE, 8, "RES 4,H", cpu_reset_bit(4, &gb->RegHL.hi);) \
+    X(0xA5, OPERAND_NONE, 8, "RES 4,L", cpu_reset_bit(4, &gb->RegHL.lo);) \
+    X(0xA6, OPERAND_NONE, 16, "RES 4,(HL)", cpu_reset_bit_hl(gb, 4, gb->RegHL.data);) \
+    X(0xA7, OPERAND_NONE, 8, "RES 4,A", cpu_reset_bit(4, &gb->RegAF.hi);) \
+    X(0xA8, OPERAND_NONE, 8, "RES 5,B", cpu_reset_bit(5, &gb->RegBC.hi);) \
+    X(0xA9, OPERAND_NONE, 8, "RES 5,C", cpu_reset_bit(5, &gb->RegBC.lo);) \
+    X(0xAA, OPERAND_NONE, 8, "RES 5,D", cpu_reset_bit(5, &gb->RegDE.hi);) \
+    X(0xAB, OPERAND_NONE, 8, "RES 5,E", cpu_reset_bit(5, &gb->RegDE.lo);) \
+    X(0xAC, OPERAND_NONE, 8, "RES 5,H", cpu_reset_bit(5, &gb->RegHL.hi);) \
+    X(0xAD, OPERAND_NONE, 8, "RES 5,L", cpu_reset_bit(5, &gb->RegHL.lo);) \
+    X(0xAE, OPERAND_NONE, 16, "RES 5,(HL)", cpu_reset_bit_hl(gb, 5, gb->RegHL.data);) \
+    X(0xAF, OPERAND_NONE, 8, "RES 5,A", cpu_reset_bit(5, &gb->RegAF.hi);) \
+    X(0xB0, OPERAND_NONE, 8, "RES 6,B", cpu_reset_bit(6, &gb->RegBC.hi);) \
+    X(0xB1, OPERAND_NONE, 8, "RES 6,C", cpu_reset_bit(6, &gb->RegBC.lo);) \
+    X(0xB2, OPERAND_NONE, 8, "RES 6,D", cpu_reset_bit(6, &gb->RegDE.hi);) \
+    X(0xB3, OPERAND_NONE, 8, "RES 6,E", cpu_reset_bit(6, &gb->RegDE.lo);) \
+    X(0xB4, OPERAND_NONE, 8, "RES 6,H", cpu_reset_bit(6, &gb->RegHL.hi);) \
+    X(0xB5, OPERAND_NONE, 8, "RES 6,L", cpu_reset_bit(6, &gb->RegHL.lo);) \
+    X(0xB6, OPERAND_NONE, 16, "RES 6,(HL)", cpu_reset_bit_hl(gb, 6, gb->RegHL.data);) \
+    X(0xB7, OPERAND_NONE, 8, "RES 6,A", cpu_reset_bit(6, &gb->RegAF.hi);) \
+    X(0xB8, OPERAND_NONE, 8, "RES 7,B", cpu_reset_bit(7, &gb->RegBC.hi);) \
+    X(0xB9, OPERAND_NONE, 8, "RES 7,C", cpu_reset_bit(7, &gb->RegBC.lo);) \
+    X(0xBA, OPERAND_NONE, 8, "RES 7,D", cpu_reset_bit(7, &gb->RegDE.hi);) \
+    X(0xBB, OPERAND_NONE, 8, "RES 7,E", cpu_reset_bit(7, &gb->RegDE.lo);) \
+    X(0xBC, OPERAND_NONE, 8, "RES 7,H", cpu_reset_bit(7, &gb->RegHL.hi);) \
+    X(0xBD, OPERAND_NONE, 8, "RES 7,L", cpu_reset_bit(7, &gb->RegHL.lo);) \
+    X(0xBE, OPERAND_NONE, 16, "RES 7,(HL)", cpu_reset_bit_hl(gb, 7, gb->RegHL.data);) \
+    X(0xBF, OPERAND_NONE, 8, "RES 7,A", cpu_reset_bit(7, &gb->RegAF.hi);) \
+    X(0xC0, OPERAND_NONE, 8, "SET 0,B", cpu_set_bit(0, &gb->RegBC.hi);) \
+    X(0xC1, OPERAND_NONE, 8, "SET 0,C", cpu_set_bit(0, &gb->RegBC.lo);) \
+    X(0xC2, OPERAND_NONE, 8, "SET 0,D", cpu_set_bit(0, &gb->RegDE.hi);) \
+    X(0xC3, OPERAND_NONE, 8, "SET 0,E", cpu_set_bit(0, &gb->RegDE.lo);) \
+    X(0xC4, OPERAND_NONE, 8, "SET 0,H", cpu_set_bit(0, &gb->RegHL.hi);) \
+    X(0xC5, OPERAND_NONE, 8, "SET 0,L", cpu_set_bit(0, &gb->RegHL.lo);) \
+    X(0xC6, OPERAND_NONE, 16, "SET 0,(HL)", cpu_set_bit_hl(gb, 0, gb->RegHL.data);) \
+    X(0xC7, OPERAND_NONE, 8, "SET 0,A", cpu_set_bit(0, &gb->RegAF.hi);) \
+    X(0xC8, OPERAND_NONE, 8, "SET 1,B", cpu_set_bit(1, &gb->RegBC.hi);) \
+    X(0xC9, OPERAND_NONE, 8, "SET 1,C", cpu_set_bit(1, &gb->RegBC.lo);) \
+    X(0xCA, OPERAND_NONE, 8, "SET 1,D", cpu_set_bit(1, &gb->RegDE.hi);) \
+    X(0xCB, OPERAND_NONE, 8, "SET 1,E", cpu_set_bit(1, &gb->RegDE.lo);) \
+    X(0xCC, OPERAND_NONE, 8, "SET 1,H", cpu_set_bit(1, &gb->RegHL.hi);) \
+    X(0xCD, OPERAND_NONE, 8, "SET 1,L", cpu_set_bit(1, &gb->RegHL.lo);) \
+    X(0xCE, OPERAND_NONE, 16, "SET 1,(HL)", cpu_set_bit_hl(gb, 1, gb->RegHL.data);) \
+    X(0xCF, OPERAND_NONE, 8, "SET 1,A", cpu_set_bit(1, &gb->RegAF.hi);) \
+    X(0xD0, OPERAND_NONE, 8, "SET 2,B", cpu_set_bit(2, &gb->RegBC.hi);) \
+    X(0xD1, OPERAND_NONE, 8, "SET 2,C", cpu_set_bit(2, &gb->RegBC.lo);) \
+    X(0xD2, OPERAND_NONE, 8, "SET 2,D", cpu_set_bit(2, &gb->RegDE.hi);) \
+    X(0xD3, OPERAND_NONE, 8, "SET 2,E", cpu_set_bit(2, &gb->RegDE.lo);) \
+    X(0xD4, OPERAND_NONE, 8, "SET 2,H", cpu_set_bit(2, &gb->RegHL.hi);) \
+    X(0xD5, OPERAND_NONE, 8, "SET 2,L", cpu_set_bit(2, &gb->RegHL.lo);) \
+    X(0xD6, OPERAND_NONE, 16, "SET 2,(HL)", cpu_set_bit_hl(gb, 2, gb->RegHL.data);) \
+    X(0xD7, OPERAND_NONE, 8, "SET 2,A", cpu_set_bit(2, &gb->RegAF.hi);) \
+    X(0xD8, OPERAND_NONE, 8, "SET 3,B", cpu_set_bit(3, &gb->RegBC.hi);) \
+    X(0xD9, OPERAND_NONE, 8, "SET 3,C", cpu_set_bit(3, &gb->RegBC.lo);) \
+    X(0xDA, OPERAND_NONE, 8, "SET 3,D", cpu_set_bit(3, &gb->RegDE.hi);) \
+    X(0xDB, OPERAND_NONE, 8, "SET 3,E", cpu_set_bit(3, &gb->RegDE.lo);) \
+    X(0xDC, OPERAND_NONE, 8, "SET 3,H", cpu_set_bit(3, &gb->RegHL.hi);) \
+    X(0xDD, OPERAND_NONE, 8, "SET 3,L", cpu_set_bit(3, &gb->RegHL.lo);) \
+    X(0xDE, OPERAND_NONE, 16, "SET 3,(HL)", cpu_set_bit_hl(gb, 3, gb->RegHL.data);) \
+    X(0xDF, OPERAND_NONE, 8, "SET 3,A", cpu_set_bit(3, &gb->RegAF.hi);) \
+    X(0xE0, OPERAND_NONE, 8, "SET 4,B", cpu_set_bit(4, &gb->RegBC.hi);) \
+    X(0xE1, OPERAND_NONE, 8, "SET 4,C", cpu_set_bit(4, &gb->RegBC.lo);) \
+    X(0xE2, OPERAND_NONE, 8, "SET 4,D", cpu_set_bit(4, &gb->RegDE.hi);) \
+    X(0xE3, OPERAND_NONE, 8, "SET 4,E", cpu_set_bit(4, &gb->RegDE.lo);) \
+    X(0xE4, OPERAND_NONE, 8, "SET 4,H", cpu_set_bit(4, &gb->RegHL.hi);) \
+    X(0xE5, OPERAND_NONE, 8, "SET 4,L", cpu_set_bit(4, &gb->RegHL.lo);) \
+    X(0xE6, OPERAND_NONE, 16, "SET 4,(HL)", cpu_set_bit_hl(gb, 4, gb->RegHL.data);) \
+    X(0xE7, OPERAND_NONE, 8, "SET 4,A", cpu_set_bit(4, &gb->RegAF.hi);) \
+    X(0xE8, OPERAND_NONE, 8, "SET 5,B", cpu_set_bit(5, &gb->RegBC.hi);) \
+    X(0xE9, OPERAND_NONE, 8, "SET 5,C", cpu_set_bit(5, &gb->RegBC.lo);) \
+    X(0xEA, OPERAND_NONE, 8, "SET 5,D", cpu_set_bit(5, &gb->RegDE.hi);) \
+    X(0xEB, OPERAND_NONE, 8, "SET 5,E", cpu_set_bit(5, &gb->RegDE.lo);) \
+    X(0xEC, OPERAND_NONE, 8, "SET 5,H", cpu_set_bit(5, &gb->RegHL.hi);) \
+    X(0xED, OPERAND_NONE, 8, "SET 5,L", cpu_set_bit(5, &gb->RegHL.lo);) \
+    X(0xEE, OPERAND_NONE, 16, "SET 5,(HL)", cpu_set_bit_hl(gb, 5, gb->RegHL.data);) \
+    X(0xEF, OPERAND_NONE, 8, "SET 5,A", cpu_set_bit(5, &gb->RegAF.hi);) \
+    X(0xF0, OPERAND_NONE, 8, "SET 6,B", cpu_set_bit(6, &gb->RegBC.hi);) \
+    X(0xF1, OPERAND_NONE, 8, "SET 6,C", cpu_set_bit(6, &gb->RegBC.lo);) \
+    X(0xF2, OPERAND_NONE, 8, "SET 6,D", cpu_set_bit(6, &gb->RegDE.hi);) \
+    X(0xF3, OPERAND_NONE, 8, "SET 6,E", cpu_set_bit(6, &gb->RegDE.lo);) \
+    X(0xF4, OPERAND_NONE, 8, "SET 6,H", cpu_set_bit(6, &gb->RegHL.hi);) \
+    X(0xF5, OPERAND_NONE, 8, "SET 6,L", cpu_set_bit(6, &gb->RegHL.lo);) \
+    X(0xF6, OPERAND_NONE, 16, "SET 6,(HL)", cpu_set_bit_hl(gb, 6, gb->RegHL.data);) \
+    X(0xF7, OPERAND_NONE, 8, "SET 6,A", cpu_set_bit(6, &gb->RegAF.hi);) \
+    X(0xF8, OPERAND_NONE, 8, "SET 7,B", cpu_set_bit(7, &gb->RegBC.hi);) \
+    X(0xF9, OPERAND_NONE, 8, "SET 7,C", cpu_set_bit(7, &gb->RegBC.lo);) \
+    X(0xFA, OPERAND_NONE, 8, "SET 7,D", cpu_set_bit(7, &gb->RegDE.hi);) \
+    X(0xFB, OPERAND_NONE, 8, "SET 7,E", cpu_set_bit(7, &gb->RegDE.lo);) \
+    X(0xFC, OPERAND_NONE, 8, "SET 7,H", cpu_set_bit(7, &gb->RegHL.hi);) \
+    X(0xFD, OPERAND_NONE, 8, "SET 7,L", cpu_set_bit(7, &gb->RegHL.lo);) \
+    X(0xFE, OPERAND_NONE, 16, "SET 7,(HL)", cpu_set_bit_hl(gb, 7, gb->RegHL.data);) \
+    X(0xFF, OPERAND_NONE, 8, "SET 7,A", cpu_set_bit(7, &gb->RegAF.hi);)
+
+#endif
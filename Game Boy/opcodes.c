@@ -0,0 +1,39 @@
+#include "gameboy.h"
+#include "opcodes.h"
+#include "opcode_list.h"
+#include "instructions.h"
+#include "memory_map.h"
+
+/*  Table driven dispatch
+    Every opcode gets its own handler with the operands and cycle count fixed at compile time,
+    so execute() is a single indirect call instead of a switch that decodes the register
+    operands out of the opcode on every instruction. The handlers and the tables of names,
+    lengths and cycles are all expanded from the lists in opcode_list.h, which gen_opcodes.py
+    writes from the description of the instruction set in opcodes.txt. Change an instruction
+    there, not here.
+*/
+
+/**************************** Handlers ****************************/
+
+#define HANDLER(op, operand, cycles, name, ...) static int main_##op(GameBoy *gb) { __VA_ARGS__ return cycles; }
+#define CB_HANDLER(op, operand, cycles, name, ...) static int cb_##op(GameBoy *gb) { __VA_ARGS__ return cycles; }
+MAIN_OPCODES(HANDLER)
+CB_OPCODES(CB_HANDLER)
+
+/**************************** Tables ****************************/
+
+#define HANDLER_ENTRY(op, ...) main_##op,
+#define CB_HANDLER_ENTRY(op, ...) cb_##op,
+#define NAME_ENTRY(op, operand, cycles, name, ...) name,
+#define OPERAND_ENTRY(op, operand, ...) operand,
+#define LENGTH_ENTRY(op, operand, ...) OPERAND_LENGTH(operand),
+#define CYCLES_ENTRY(op, operand, cycles, ...) cycles,
+
+const OPCODE_HANDLER main_table[256] = { MAIN_OPCODES(HANDLER_ENTRY) };
+const OPCODE_HANDLER cb_table[256] = { CB_OPCODES(CB_HANDLER_ENTRY) };
+const char *const opcode_names[256] = { MAIN_OPCODES(NAME_ENTRY) };
+const char *const cb_opcode_names[256] = { CB_OPCODES(NAME_ENTRY) };
+const BYTE opcode_operands[256] = { MAIN_OPCODES(OPERAND_ENTRY) };
+const BYTE opcode_lengths[256] = { MAIN_OPCODES(LENGTH_ENTRY) };
+const BYTE opcode_cycles[256] = { MAIN_OPCODES(CYCLES_ENTRY) };
+const BYTE cb_opcode_cycles[256] = { CB_OPCODES(CYCLES_ENTRY) };
@@ -0,0 +1,40 @@
+#ifndef OPCODES_H
+#define OPCODES_H
+#include "cpu.h"
+
+/* Each handler executes one instruction and returns the number of cycles it took.
+   The opcode byte has already been fetched, so PC points at the first operand. */
+typedef int (*OPCODE_HANDLER)(GameBoy *gb);
+
+/* Handlers for the main instruction set, indexed by opcode */
+extern const OPCODE_HANDLER main_table[256];
+
+/* Handlers for the CB prefixed instruction set, indexed by the byte after 0xCB */
+extern const OPCODE_HANDLER cb_table[256];
+
+/* What follows the opcode byte of an instruction */
+typedef enum {
+    OPERAND_NONE,
+    OPERAND_N,      // Immediate byte
+    OPERAND_NN,     // Immediate word, low byte first
+    OPERAND_E,      // Signed jump offset from the end of the instruction
+    OPERAND_CB      // Opcode of a CB prefixed instruction
+} OPERAND;
+
+/* Number of bytes in an instruction with the operand, counting the opcode */
+#define OPERAND_LENGTH(operand) ((operand) == OPERAND_NONE ? 1 : (operand) == OPERAND_NN ? 3 : 2)
+
+/* Mnemonics indexed by opcode, as printf formats for the operand. Invalid opcodes are "INVALID" */
+extern const char *const opcode_names[256];
+extern const char *const cb_opcode_names[256];
+
+/* OPERAND of each opcode, and the length of its instruction */
+extern const BYTE opcode_operands[256];
+extern const BYTE opcode_lengths[256];
+
+/* Cycles each instruction takes, the same as its handler returns. Invalid opcodes take 0 and
+   so does the 0xCB prefix, whose instructions have all of their cycles in cb_opcode_cycles */
+extern const BYTE opcode_cycles[256];
+extern const BYTE cb_opcode_cycles[256];
+
+#endif
@@ -0,0 +1,120 @@
+#include <string.h>
+#include <time.h>
+#include "gameboy.h"
+#include "rtc.h"
+
+/*  MBC3 real time clock
+    Nothing ticks. The clock is kept as the seconds it read at the cycle in rtc_base, and the time
+    is worked out from total_cycles only when the game latches or writes a register, so it costs
+    nothing while running, however fast, and skipped idle loops and batch instances keep time with
+    the emulated CPU rather than the host.
+
+    A .sav holds the clock in the layout other emulators use: the five registers and the five latched
+    registers as 32 bit little endian words, then the time the file was written, 64 bit seconds
+    since 1970. The time between that and loading is added, as the clock keeps running on its battery.
+*/
+
+#define CYCLES_PER_SECOND 4194304
+#define SECONDS_PER_DAY 86400ULL
+#define RTC_DAYS 512        // The day counter has 9 bits
+#define DAY_HIGH_HALT 0x40
+#define DAY_HIGH_CARRY 0x80
+
+/* Bring the clock up to total_cycles and return the seconds on it */
+static unsigned long long rtc_now(GameBoy *gb) {
+    if (!gb->rtc_halt && gb->total_cycles > gb->rtc_base) {
+        // Keep the part of a second that has gone by in rtc_base
+        unsigned long long elapsed = (gb->total_cycles - gb->rtc_base) / CYCLES_PER_SECOND;
+        gb->rtc_seconds += elapsed;
+        gb->rtc_base += elapsed * CYCLES_PER_SECOND;
+    }
+    if (gb->rtc_seconds >= RTC_DAYS * SECONDS_PER_DAY) {
+        gb->rtc_seconds %= RTC_DAYS * SECONDS_PER_DAY;
+        gb->rtc_carry = 1;
+    }
+    return gb->rtc_seconds;
+}
+
+static void registers(GameBoy *gb, BYTE *values) {
+    unsigned long long seconds = rtc_now(gb);
+    unsigned int day = (unsigned int)(seconds / SECONDS_PER_DAY);
+    values[RTC_SECONDS] = seconds % 60;
+    values[RTC_MINUTES] = seconds / 60 % 60;
+    values[RTC_HOURS] = seconds / 3600 % 24;
+    values[RTC_DAY_LOW] = day & 0xFF;
+    values[RTC_DAY_HIGH] = day >> 8 | (gb->rtc_halt ? DAY_HIGH_HALT : 0) | (gb->rtc_carry ? DAY_HIGH_CARRY : 0);
+}
+
+/* Set the clock from register values. Out of range values are kept as far as they fit, where the
+   hardware would count on from them and wrap without a carry */
+static void set_registers(GameBoy *gb, const BYTE *values) {
+    unsigned int day = (values[RTC_DAY_HIGH] & 0x01) << 8 | values[RTC_DAY_LOW];
+    gb->rtc_seconds = ((day * 24ULL + (values[RTC_HOURS] & 0x1F)) * 60 + (values[RTC_MINUTES] & 0x3F)) * 60
+        + (values[RTC_SECONDS] & 0x3F);
+    gb->rtc_halt = (values[RTC_DAY_HIGH] & DAY_HIGH_HALT) != 0;
+    gb->rtc_carry = (values[RTC_DAY_HIGH] & DAY_HIGH_CARRY) != 0;
+}
+
+void rtc_init(GameBoy *gb) {
+    gb->rtc_seconds = 0;
+    gb->rtc_base = gb->total_cycles;
+    gb->rtc_halt = 0;
+    gb->rtc_carry = 0;
+    gb->rtc_latch_value = 0xFF;
+    memset(gb->rtc_latched, 0, sizeof(gb->rtc_latched));
+}
+
+void rtc_latch(GameBoy *gb, BYTE data) {
+    if (gb->rtc_latch_value == 0x00 && data == 0x01)
+        registers(gb, gb->rtc_latched);
+    gb->rtc_latch_value = data;
+}
+
+BYTE rtc_read(GameBoy *gb, RTC_REGISTER reg) {
+    return gb->rtc_latched[reg];
+}
+
+void rtc_write(GameBoy *gb, RTC_REGISTER reg, BYTE data) {
+    BYTE values[RTC_REGISTERS];
+    int halted = gb->rtc_halt;
+    registers(gb, values);
+    values[reg] = data;
+    set_registers(gb, values);
+    // Writing the seconds starts a new second, and a halted clock starts from where it stopped
+    if (reg == RTC_SECONDS || (halted && !gb->rtc_halt))
+        gb->rtc_base = gb->total_cycles;
+}
+
+void rtc_save(GameBoy *gb, BYTE *footer) {
+    BYTE values[RTC_REGISTERS];
+    registers(gb, values);
+    memset(footer, 0, RTC_SAVE_SIZE);
+    for (int i = 0; i < RTC_REGISTERS; i++) {
+        footer[i * 4] = values[i];
+        footer[(RTC_REGISTERS + i) * 4] = gb->rtc_latched[i];
+    }
+    unsigned long long now = (unsigned long long)time(NULL);
+    for (int i = 0; i < 8; i++)
+        footer[RTC_REGISTERS * 8 + i] = (BYTE)(now >> (i * 8));
+}
+
+void rtc_load(GameBoy *gb, const BYTE *footer, unsigned int size) {
+    // Some emulators write the time as 32 bits
+    if (size < RTC_REGISTERS * 8 + 4)
+        return;
+    BYTE values[RTC_REGISTERS];
+    for (int i = 0; i < RTC_REGISTERS; i++) {
+        values[i] = footer[i * 4];
+        gb->rtc_latched[i] = footer[(RTC_REGISTERS + i) * 4];
+    }
+    unsigned long long saved = 0;
+    for (unsigned int i = 0; i < (size >= RTC_SAVE_SIZE ? 8u : 4u); i++)
+        saved |= (unsigned long long)footer[RTC_REGISTERS * 8 + i] << (i * 8);
+
+    set_registers(gb, values);
+    gb->rtc_base = gb->total_cycles;
+    unsigned long long now = (unsigned long long)time(NULL);
+    if (!gb->rtc_halt && now > saved)
+        gb->rtc_seconds += now - saved;
+    rtc_now(gb);
+}
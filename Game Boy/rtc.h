@@ -0,0 +1,31 @@
+#ifndef RTC_H
+#define RTC_H
+#include "cpu.h"
+
+#define RTC_SAVE_SIZE 48    // Bytes the clock adds after the RAM in a .sav
+
+/* Clock registers, selected by writing 0x08-0x0C to the MBC3 RAM bank register */
+typedef enum {
+    RTC_SECONDS,
+    RTC_MINUTES,
+    RTC_HOURS,
+    RTC_DAY_LOW,
+    RTC_DAY_HIGH,   // Bit 0 is bit 8 of the day counter, bit 6 halts the clock, bit 7 is the day carry
+    RTC_REGISTERS
+} RTC_REGISTER;
+
+/* Set the clock of a new cartridge to day 0, 00:00:00. Called by mbc_init() */
+void rtc_init(GameBoy *gb);
+
+/* A write to 6000-7FFF. Writing 0x00 then 0x01 copies the time into the registers the game reads */
+void rtc_latch(GameBoy *gb, BYTE data);
+
+BYTE rtc_read(GameBoy *gb, RTC_REGISTER reg);
+void rtc_write(GameBoy *gb, RTC_REGISTER reg, BYTE data);
+
+/* Store the clock in, or restore it from, the RTC_SAVE_SIZE bytes after the RAM in a .sav. Loading
+   adds the time since the save was written, as the clock runs while the Game Boy is off */
+void rtc_save(GameBoy *gb, BYTE *footer);
+void rtc_load(GameBoy *gb, const BYTE *footer, unsigned int size);
+
+#endif
@@ -0,0 +1,79 @@
+#include "gameboy.h"
+#include "scheduler.h"
+#include "display.h"
+#include "timer.h"
+#include "interrupts.h"
+#include "dma.h"
+#include "battery.h"
+
+static void update_next_event(GameBoy *gb) {
+    gb->next_event = NEVER;
+    for (int i = 0; i < EVENT_COUNT; i++) {
+        if (gb->deadline[i] < gb->next_event)
+            gb->next_event = gb->deadline[i];
+    }
+    // An event scheduled while instructions run has to stop them in time to be serviced
+    if (gb->next_event < gb->stop_cycle)
+        gb->stop_cycle = gb->next_event;
+}
+
+void scheduler_init(GameBoy *gb) {
+    gb->total_cycles = 0;
+    for (int i = 0; i < EVENT_COUNT; i++) {
+        gb->deadline[i] = NEVER;
+        gb->last_run[i] = 0;
+    }
+    schedule_event(gb, EVENT_PPU, 0);
+    schedule_event(gb, EVENT_TIMER, 0);
+    schedule_event(gb, EVENT_INTERRUPT, 0);
+}
+
+void schedule_event(GameBoy *gb, EVENT event, unsigned long long when) {
+    gb->deadline[event] = when;
+    update_next_event(gb);
+}
+
+static void service(GameBoy *gb, EVENT event) {
+    int elapsed = (int)(gb->total_cycles - gb->last_run[event]);
+    gb->last_run[event] = gb->total_cycles;
+    gb->deadline[event] = NEVER;
+
+    switch (event) {
+    case EVENT_PPU:
+        draw(gb, elapsed);
+        gb->deadline[event] = gb->total_cycles + cycles_until_mode_change(gb);
+        break;
+    case EVENT_TIMER:
+        timer(gb, elapsed);
+        gb->deadline[event] = gb->total_cycles + cycles_until_tick(gb);
+        break;
+    case EVENT_DMA:
+        dma_sync(gb);
+        break;
+    case EVENT_INTERRUPT:
+        // Rescheduled by update_interrupts() once an interrupt is pending with IME set
+        interrupt_handler(gb);
+        break;
+    case EVENT_SAVE:
+        battery_sync(gb);
+        break;
+    default:
+        break;
+    }
+}
+
+void sync_event(GameBoy *gb, EVENT event) {
+    service(gb, event);
+    update_next_event(gb);
+}
+
+void run_events(GameBoy *gb) {
+    while (gb->next_event <= gb->total_cycles) {
+        for (int i = 0; i < EVENT_COUNT; i++) {
+            if (gb->deadline[i] <= gb->total_cycles) {
+                service(gb, i);
+            }
+        }
+        update_next_event(gb);
+    }
+}
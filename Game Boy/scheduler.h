@@ -0,0 +1,29 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+#include "cpu.h"
+
+#define NEVER 0xFFFFFFFFFFFFFFFFULL
+
+/* Events are serviced in this order when they are due on the same cycle */
+typedef enum {
+    EVENT_PPU,          // Next LCD mode change
+    EVENT_TIMER,        // Next DIV or TIMA increment
+    EVENT_DMA,          // End of an OAM DMA transfer
+    EVENT_INTERRUPT,    // Check for pending interrupts
+    EVENT_SAVE,         // Hand battery backed RAM written since the last save to the save thread
+    EVENT_COUNT
+} EVENT;
+
+void scheduler_init(GameBoy *gb);
+
+/* Service the event at the given cycle. Replaces any earlier deadline for the same event, and brings
+   stop_cycle forward if the event is due before it */
+void schedule_event(GameBoy *gb, EVENT event, unsigned long long when);
+
+/* Bring an event's component up to the current cycle right away, e.g. before one of its registers is written */
+void sync_event(GameBoy *gb, EVENT event);
+
+/* Service every event that is due */
+void run_events(GameBoy *gb);
+
+#endif
@@ -0,0 +1,414 @@
+#include <stddef.h>
+#include "gameboy.h"
+#include "threaded.h"
+#include "opcodes.h"
+#include "opcode_list.h"
+#include "flags.h"
+#include "memory_map.h"
+#include "idle_loop.h"
+
+#if THREADED
+
+/*  Threaded interpreter
+    One function runs every instruction. The registers, PC, SP and the cycle count are locals, so the
+    compiler can keep them in host registers instead of loading and storing the Register unions in the
+    GameBoy on every instruction. Each handler ends by fetching the next opcode and jumping straight to its
+    handler, with computed goto on GCC and Clang, and with a switch elsewhere. The flags are worked
+    out in F as the eager helpers in instructions.c do, whatever FLAG_MODE is.
+
+    The locals are written back to the GameBoy before anything that needs them: the handlers in
+    opcodes.c, which run the instructions that are not done here, and read_memory() or write_memory()
+    for addresses without a page, which only need total_cycles. Cycle counts are the same as the
+    handler tables, and the table of labels comes from the opcode list in opcode_list.h.
+
+    The interpreter only returns when stop_cycle is reached or the CPU halts, so a loop runs all its
+    iterations in locals. A jump back is where idle loops are looked for, and idle_loop_check() is called
+    from here with only PC and the cycle count written back, as it needs nothing else. Once it has found
+    that a jump does not close an idle loop, the jump is not checked again until another one is.
+*/
+
+#ifndef THREADED_GOTO
+#if defined(__GNUC__) || defined(__clang__)
+#define THREADED_GOTO 1
+#else
+#define THREADED_GOTO 0
+#endif
+#endif
+
+#define Z_FLAG (1 << FLAG_Z)
+#define N_FLAG (1 << FLAG_N)
+#define H_FLAG (1 << FLAG_H)
+#define C_FLAG (1 << FLAG_C)
+
+static BYTE read_byte(GameBoy *gb, WORD address, unsigned long long cycles) {
+    BYTE *page = gb->read_page[address >> 8];
+    if (page != NULL)
+        return page[address & 0xFF];
+    gb->total_cycles = cycles;
+    return read_memory(gb, address);
+}
+
+static void write_byte(GameBoy *gb, WORD address, BYTE data, unsigned long long cycles) {
+    BYTE *page = gb->write_page[address >> 8];
+    if (page != NULL) {
+        page[address & 0xFF] = data;
+        return;
+    }
+    gb->total_cycles = cycles;
+    write_memory(gb, address, data);
+}
+
+#define READ(address) read_byte(gb, (WORD)(address), cycles)
+#define WRITE(address, data) write_byte(gb, (WORD)(address), (data), cycles)
+#define PAIR(hi, lo) ((WORD)((hi) << 8 | (lo)))
+#define SET_PAIR(hi, lo, value) do { WORD v_ = (WORD)(value); hi = (BYTE)(v_ >> 8); lo = (BYTE)v_; } while (0)
+#define READ_NN(nn) do { nn = READ(pc++); nn |= READ(pc++) << 8; } while (0)
+#define PUSH(hi, lo) do { WRITE(--sp, hi); WRITE(--sp, lo); } while (0)
+#define POP(hi, lo) do { lo = READ(sp++); hi = READ(sp++); } while (0)
+
+#define SAVE_REGISTERS() do { \
+    gb->RegAF.hi = a; gb->RegAF.lo = f; discard_flags(gb); \
+    gb->RegBC.hi = b; gb->RegBC.lo = c; gb->RegDE.hi = d; gb->RegDE.lo = e; \
+    gb->RegHL.hi = h; gb->RegHL.lo = l; gb->RegSP.data = sp; gb->PC = pc; gb->total_cycles = cycles; \
+} while (0)
+
+#define LOAD_REGISTERS() do { \
+    sync_flags(gb); a = gb->RegAF.hi; f = gb->RegAF.lo; \
+    b = gb->RegBC.hi; c = gb->RegBC.lo; d = gb->RegDE.hi; e = gb->RegDE.lo; \
+    h = gb->RegHL.hi; l = gb->RegHL.lo; sp = gb->RegSP.data; pc = gb->PC; cycles = gb->total_cycles; \
+} while (0)
+
+/**************************** Dispatch ****************************/
+
+#if THREADED_GOTO
+#define OP(n) op_0x##n:
+#define DISPATCH() goto *labels[op]
+#define LABEL_ENTRY(op, ...) &&op_##op,
+#else
+#define OP(n) case 0x##n:
+#define DISPATCH() goto dispatch
+#endif
+
+/* After a jump back from last to pc, let idle_loop_check() skip iterations of an idle loop, unless the
+   last jump it was asked about was this one and was busy. Any other jump makes it watch another loop */
+#if IDLE_LOOP_SKIP
+#define CHECK_IDLE_LOOP() do { \
+    if (pc <= last && (pc != busy_start || last != busy_branch)) { \
+        gb->PC = pc; \
+        gb->total_cycles = cycles; \
+        int idle_ = idle_loop_check(gb, last); \
+        busy_start = idle_ ? NO_JUMP_START : pc; \
+        busy_branch = idle_ ? NO_JUMP_BRANCH : last; \
+        cycles = gb->total_cycles; \
+    } \
+} while (0)
+
+/* A jump from 0000 to FFFF does not go back, so it is never checked */
+#define NO_JUMP_START 0xFFFF
+#define NO_JUMP_BRANCH 0x0000
+#else
+#define CHECK_IDLE_LOOP() ((void)0)
+#endif
+
+/* Stop once stop_cycle is reached, otherwise go on to the next instruction. stop_cycle is read each
+   time, as an instruction that schedules an event can lower it */
+#define NEXT(n) do { \
+    cycles += (n); \
+    CHECK_IDLE_LOOP(); \
+    if (cycles >= gb->stop_cycle) \
+        goto done; \
+    last = pc; \
+    op = MEMORY_AT(gb, pc); \
+    pc++; \
+    DISPATCH(); \
+} while (0)
+
+/* The registers in opcode encoding order, leaving out (HL), for opcodes hi0-hi7 and hi8-hiF */
+#define REGS_LO(X, hi, arg) X(hi##0, arg, b) X(hi##1, arg, c) X(hi##2, arg, d) X(hi##3, arg, e) X(hi##4, arg, h) X(hi##5, arg, l) X(hi##7, arg, a)
+#define REGS_HI(X, hi, arg) X(hi##8, arg, b) X(hi##9, arg, c) X(hi##A, arg, d) X(hi##B, arg, e) X(hi##C, arg, h) X(hi##D, arg, l) X(hi##F, arg, a)
+
+/**************************** ALU ****************************/
+
+#define ALU_ADD(value) { \
+    BYTE n_ = (value); unsigned int r_ = a + n_; \
+    f = (r_ > 0xFF ? C_FLAG : 0) | ((a & 0x0F) + (n_ & 0x0F) > 0x0F ? H_FLAG : 0) | ((BYTE)r_ == 0 ? Z_FLAG : 0); \
+    a = (BYTE)r_; }
+
+#define ALU_ADC(value) { \
+    BYTE n_ = (value); BYTE cy_ = (f & C_FLAG) >> FLAG_C; unsigned int r_ = a + n_ + cy_; \
+    f = (r_ > 0xFF ? C_FLAG : 0) | ((a & 0x0F) + (n_ & 0x0F) + cy_ > 0x0F ? H_FLAG : 0) | ((BYTE)r_ == 0 ? Z_FLAG : 0); \
+    a = (BYTE)r_; }
+
+#define ALU_SUB(value) { \
+    BYTE n_ = (value); BYTE r_ = a - n_; \
+    f = N_FLAG | (a < n_ ? C_FLAG : 0) | ((a & 0x0F) < (n_ & 0x0F) ? H_FLAG : 0) | (r_ == 0 ? Z_FLAG : 0); \
+    a = r_; }
+
+#define ALU_SBC(value) { \
+    BYTE n_ = (value); BYTE cy_ = (f & C_FLAG) >> FLAG_C; int r_ = a - n_ - cy_; \
+    f = N_FLAG | (r_ < 0 ? C_FLAG : 0) | ((a & 0x0F) - (n_ & 0x0F) - cy_ < 0 ? H_FLAG : 0) | ((BYTE)r_ == 0 ? Z_FLAG : 0); \
+    a = (BYTE)r_; }
+
+#define ALU_AND(value) { a &= (value); f = H_FLAG | (a == 0 ? Z_FLAG : 0); }
+#define ALU_XOR(value) { a ^= (value); f = a == 0 ? Z_FLAG : 0; }
+#define ALU_OR(value) { a |= (value); f = a == 0 ? Z_FLAG : 0; }
+
+#define ALU_CP(value) { \
+    BYTE n_ = (value); \
+    f = N_FLAG | (a < n_ ? C_FLAG : 0) | ((a & 0x0F) < (n_ & 0x0F) ? H_FLAG : 0) | (a == n_ ? Z_FLAG : 0); }
+
+#define INC8(r) { f = (f & C_FLAG) | ((r & 0x0F) == 0x0F ? H_FLAG : 0); r++; if (r == 0) f |= Z_FLAG; }
+#define DEC8(r) { f = (f & C_FLAG) | N_FLAG | ((r & 0x0F) == 0 ? H_FLAG : 0); r--; if (r == 0) f |= Z_FLAG; }
+
+#define ADD_HL(value) { \
+    WORD n_ = (value); WORD hl_ = PAIR(h, l); \
+    f = (f & Z_FLAG) | (hl_ + n_ > 0xFFFF ? C_FLAG : 0) | ((hl_ & 0xFFF) + (n_ & 0xFFF) > 0xFFF ? H_FLAG : 0); \
+    SET_PAIR(h, l, hl_ + n_); }
+
+/**************************** Handlers ****************************/
+
+#define LD_R_R(op, dst, src) OP(op) dst = src; NEXT(4);
+#define LD_MHL_R(op, unused, src) OP(op) WRITE(PAIR(h, l), src); NEXT(8);
+#define ALU_R(op, alu, src) OP(op) alu(src); NEXT(4);
+
+#define NZ_TAKEN !(f & Z_FLAG)
+#define Z_TAKEN (f & Z_FLAG)
+#define NC_TAKEN !(f & C_FLAG)
+#define C_TAKEN (f & C_FLAG)
+#define ALWAYS 1
+
+#define JR(op, cond, cycles) OP(op) { SIGNED_BYTE n = (SIGNED_BYTE)READ(pc++); if (cond) pc += n; NEXT(cycles); }
+#define JP(op, cond) OP(op) { WORD nn; READ_NN(nn); if (cond) pc = nn; NEXT(12); }
+#define CALL(op, cond) OP(op) { WORD nn; READ_NN(nn); if (cond) { PUSH(pc >> 8, (BYTE)pc); pc = nn; } NEXT(12); }
+#define RET(op, cond) OP(op) { if (cond) { BYTE hi, lo; POP(hi, lo); pc = PAIR(hi, lo); } NEXT(8); }
+#define RST(op, n) OP(op) PUSH(pc >> 8, (BYTE)pc); pc = n; NEXT(32);
+
+WORD run_threaded(GameBoy *gb) {
+#if THREADED_GOTO
+    static const void *const labels[256] = { MAIN_OPCODES(LABEL_ENTRY) };
+#endif
+    BYTE a, f, b, c, d, e, h, l;
+    WORD sp, pc;
+    unsigned long long cycles;
+    OPCODE_HANDLER handler;
+    BYTE op;
+
+    LOAD_REGISTERS();
+    WORD last = pc;
+#if IDLE_LOOP_SKIP
+    // The jump back idle_loop_check() last found not to close an idle loop
+    WORD busy_start = NO_JUMP_START, busy_branch = NO_JUMP_BRANCH;
+#endif
+    op = MEMORY_AT(gb, pc);
+    pc++;
+#if THREADED_GOTO
+    DISPATCH();
+#else
+dispatch:
+    switch (op) {
+#endif
+
+    /* 8-Bit Loads */
+    REGS_LO(LD_R_R, 4, b) REGS_HI(LD_R_R, 4, c)
+    REGS_LO(LD_R_R, 5, d) REGS_HI(LD_R_R, 5, e)
+    REGS_LO(LD_R_R, 6, h) REGS_HI(LD_R_R, 6, l)
+    REGS_HI(LD_R_R, 7, a)
+    OP(46) b = READ(PAIR(h, l)); NEXT(8);
+    OP(4E) c = READ(PAIR(h, l)); NEXT(8);
+    OP(56) d = READ(PAIR(h, l)); NEXT(8);
+    OP(5E) e = READ(PAIR(h, l)); NEXT(8);
+    OP(66) h = READ(PAIR(h, l)); NEXT(8);
+    OP(6E) l = READ(PAIR(h, l)); NEXT(8);
+    OP(7E) a = READ(PAIR(h, l)); NEXT(8);
+    REGS_LO(LD_MHL_R, 7, 0)
+    OP(06) b = READ(pc++); NEXT(8);
+    OP(0E) c = READ(pc++); NEXT(8);
+    OP(16) d = READ(pc++); NEXT(8);
+    OP(1E) e = READ(pc++); NEXT(8);
+    OP(26) h = READ(pc++); NEXT(8);
+    OP(2E) l = READ(pc++); NEXT(8);
+    OP(3E) a = READ(pc++); NEXT(8);
+    OP(36) { BYTE n = READ(pc++); WRITE(PAIR(h, l), n); NEXT(12); }
+    OP(0A) a = READ(PAIR(b, c)); NEXT(8);
+    OP(1A) a = READ(PAIR(d, e)); NEXT(8);
+    OP(FA) { WORD nn; READ_NN(nn); a = READ(nn); NEXT(16); }
+    OP(02) WRITE(PAIR(b, c), a); NEXT(8);
+    OP(12) WRITE(PAIR(d, e), a); NEXT(8);
+    OP(EA) { WORD nn; READ_NN(nn); WRITE(nn, a); NEXT(16); }
+    OP(F2) a = READ(0xFF00 + c); NEXT(8);
+    OP(E2) WRITE(0xFF00 + c, a); NEXT(8);
+    OP(2A) a = READ(PAIR(h, l)); SET_PAIR(h, l, PAIR(h, l) + 1); NEXT(8);
+    OP(3A) a = READ(PAIR(h, l)); SET_PAIR(h, l, PAIR(h, l) - 1); NEXT(8);
+    OP(22) WRITE(PAIR(h, l), a); SET_PAIR(h, l, PAIR(h, l) + 1); NEXT(8);
+    OP(32) WRITE(PAIR(h, l), a); SET_PAIR(h, l, PAIR(h, l) - 1); NEXT(8);
+    OP(E0) { BYTE n = READ(pc++); WRITE(0xFF00 + n, a); NEXT(12); }
+    OP(F0) { BYTE n = READ(pc++); a = READ(0xFF00 + n); NEXT(12); }
+
+    /* 16-Bit Loads */
+    OP(01) c = READ(pc++); b = READ(pc++); NEXT(12);
+    OP(11) e = READ(pc++); d = READ(pc++); NEXT(12);
+    OP(21) l = READ(pc++); h = READ(pc++); NEXT(12);
+    OP(31) READ_NN(sp); NEXT(12);
+    OP(F9) sp = PAIR(h, l); NEXT(8);
+    OP(C5) PUSH(b, c); NEXT(16);
+    OP(D5) PUSH(d, e); NEXT(16);
+    OP(E5) PUSH(h, l); NEXT(16);
+    OP(F5) PUSH(a, f); NEXT(16);
+    OP(C1) POP(b, c); NEXT(12);
+    OP(D1) POP(d, e); NEXT(12);
+    OP(E1) POP(h, l); NEXT(12);
+    OP(F1) f = READ(sp++) & 0xF0; a = READ(sp++); NEXT(12);
+
+    /* 8-Bit ALU */
+    REGS_LO(ALU_R, 8, ALU_ADD) REGS_HI(ALU_R, 8, ALU_ADC)
+    REGS_LO(ALU_R, 9, ALU_SUB) REGS_HI(ALU_R, 9, ALU_SBC)
+    REGS_LO(ALU_R, A, ALU_AND) REGS_HI(ALU_R, A, ALU_XOR)
+    REGS_LO(ALU_R, B, ALU_OR) REGS_HI(ALU_R, B, ALU_CP)
+    OP(86) ALU_ADD(READ(PAIR(h, l))); NEXT(8);
+    OP(8E) ALU_ADC(READ(PAIR(h, l))); NEXT(8);
+    OP(96) ALU_SUB(READ(PAIR(h, l))); NEXT(8);
+    OP(9E) ALU_SBC(READ(PAIR(h, l))); NEXT(8);
+    OP(A6) ALU_AND(READ(PAIR(h, l))); NEXT(8);
+    OP(AE) ALU_XOR(READ(PAIR(h, l))); NEXT(8);
+    OP(B6) ALU_OR(READ(PAIR(h, l))); NEXT(8);
+    OP(BE) ALU_CP(MEMORY_AT(gb, PAIR(h, l))); NEXT(8);     // Reads memory directly, like cp_mhl()
+    OP(C6) ALU_ADD(READ(pc++)); NEXT(8);
+    OP(CE) ALU_ADC(READ(pc++)); NEXT(8);
+    OP(D6) ALU_SUB(READ(pc++)); NEXT(8);
+    OP(DE) ALU_SBC(READ(pc++)); NEXT(8);
+    OP(E6) ALU_AND(READ(pc++)); NEXT(8);
+    OP(EE) ALU_XOR(READ(pc++)); NEXT(8);
+    OP(F6) ALU_OR(READ(pc++)); NEXT(8);
+    OP(FE) ALU_CP(READ(pc++)); NEXT(8);
+    OP(04) INC8(b); NEXT(4);
+    OP(0C) INC8(c); NEXT(4);
+    OP(14) INC8(d); NEXT(4);
+    OP(1C) INC8(e); NEXT(4);
+    OP(24) INC8(h); NEXT(4);
+    OP(2C) INC8(l); NEXT(4);
+    OP(3C) INC8(a); NEXT(4);
+    OP(05) DEC8(b); NEXT(4);
+    OP(0D) DEC8(c); NEXT(4);
+    OP(15) DEC8(d); NEXT(4);
+    OP(1D) DEC8(e); NEXT(4);
+    OP(25) DEC8(h); NEXT(4);
+    OP(2D) DEC8(l); NEXT(4);
+    OP(3D) DEC8(a); NEXT(4);
+    OP(34) { BYTE n = READ(PAIR(h, l)); INC8(n); WRITE(PAIR(h, l), n); NEXT(12); }
+    OP(35) { BYTE n = READ(PAIR(h, l)); DEC8(n); WRITE(PAIR(h, l), n); NEXT(12); }
+    OP(27) {
+        BYTE n = 0x00;
+        if (!(f & N_FLAG)) {
+            if (a > 0x99 || (f & C_FLAG)) {
+                f |= C_FLAG;
+                n |= 0x60;
+            }
+            if ((a & 0x0F) > 0x09 || (f & H_FLAG))
+                n |= 0x06;
+        }
+        else {
+            if ((f & C_FLAG) && !(f & H_FLAG))
+                n |= 0xA0;
+            if (f & H_FLAG)
+                n |= (f & C_FLAG) ? 0x9A : 0xFA;
+        }
+        a += n;
+        f = (f & ~(Z_FLAG | H_FLAG)) | (a == 0 ? Z_FLAG : 0);
+        NEXT(4);
+    }
+    OP(07) f = (a & 0x80) ? C_FLAG : 0; a = (BYTE)(a << 1 | a >> 7); NEXT(4);
+    OP(0F) f = (a & 0x01) ? C_FLAG : 0; a = (BYTE)(a >> 1 | a << 7); NEXT(4);
+    OP(17) { BYTE cy = (f & C_FLAG) >> FLAG_C; f = (a & 0x80) ? C_FLAG : 0; a = (BYTE)(a << 1 | cy); NEXT(4); }
+    OP(1F) { BYTE cy = (f & C_FLAG) >> FLAG_C; f = (a & 0x01) ? C_FLAG : 0; a = (BYTE)(a >> 1 | cy << 7); NEXT(4); }
+    OP(2F) a ^= 0xFF; f |= N_FLAG | H_FLAG; NEXT(4);
+    OP(37) f = (f & ~(N_FLAG | H_FLAG)) | C_FLAG; NEXT(4);
+    OP(3F) f = (f ^ C_FLAG) & ~(N_FLAG | H_FLAG); NEXT(4);
+
+    /* 16-Bit Arithmetic */
+    OP(09) ADD_HL(PAIR(b, c)); NEXT(8);
+    OP(19) ADD_HL(PAIR(d, e)); NEXT(8);
+    OP(29) ADD_HL(PAIR(h, l)); NEXT(8);
+    OP(39) ADD_HL(sp); NEXT(8);
+    OP(03) SET_PAIR(b, c, PAIR(b, c) + 1); NEXT(8);
+    OP(13) SET_PAIR(d, e, PAIR(d, e) + 1); NEXT(8);
+    OP(23) SET_PAIR(h, l, PAIR(h, l) + 1); NEXT(8);
+    OP(33) sp++; NEXT(8);
+    OP(0B) SET_PAIR(b, c, PAIR(b, c) - 1); NEXT(8);
+    OP(1B) SET_PAIR(d, e, PAIR(d, e) - 1); NEXT(8);
+    OP(2B) SET_PAIR(h, l, PAIR(h, l) - 1); NEXT(8);
+    OP(3B) sp--; NEXT(8);
+
+    /* Jumps, Calls, Returns */
+    OP(00) NEXT(4);
+    OP(F3) gb->IME = 0; NEXT(4);
+    JR(18, ALWAYS, 12) JR(20, NZ_TAKEN, 8) JR(28, Z_TAKEN, 8) JR(30, NC_TAKEN, 8) JR(38, C_TAKEN, 8)
+    JP(C3, ALWAYS) JP(C2, NZ_TAKEN) JP(CA, Z_TAKEN) JP(D2, NC_TAKEN) JP(DA, C_TAKEN)
+    OP(E9) pc = PAIR(h, l); NEXT(4);
+    CALL(CD, ALWAYS) CALL(C4, NZ_TAKEN) CALL(CC, Z_TAKEN) CALL(D4, NC_TAKEN) CALL(DC, C_TAKEN)
+    RET(C9, ALWAYS) RET(C0, NZ_TAKEN) RET(C8, Z_TAKEN) RET(D0, NC_TAKEN) RET(D8, C_TAKEN)
+    RST(C7, 0x00) RST(CF, 0x08) RST(D7, 0x10) RST(DF, 0x18) RST(E7, 0x20) RST(EF, 0x28) RST(F7, 0x30) RST(FF, 0x38)
+
+    /* CB prefix. BIT, RES and SET are done here, the rotates, shifts and SWAP by their handlers */
+    OP(CB) {
+        BYTE cb = MEMORY_AT(gb, pc);
+        pc++;
+        BYTE bit = 1 << ((cb >> 3) & 0x07);
+        if (cb < 0x40) {
+            op = cb;
+            handler = cb_table[cb];
+            goto call_handler;
+        }
+#define BIT_OP(r) \
+        if (cb < 0x80) f = (f & ~(Z_FLAG | N_FLAG)) | H_FLAG | ((r) & bit ? 0 : Z_FLAG); \
+        else if (cb < 0xC0) r &= ~bit; \
+        else r |= bit;
+        switch (cb & 0x07) {
+        case REGB: BIT_OP(b) break;
+        case REGC: BIT_OP(c) break;
+        case REGD: BIT_OP(d) break;
+        case REGE: BIT_OP(e) break;
+        case REGH: BIT_OP(h) break;
+        case REGL: BIT_OP(l) break;
+        case REGA: BIT_OP(a) break;
+        default: {
+            BYTE n = READ(PAIR(h, l));
+            if (cb < 0x80) {
+                BIT_OP(n)
+            }
+            else {
+                BIT_OP(n)
+                WRITE(PAIR(h, l), n);
+            }
+            NEXT(16);
+        }
+        }
+#undef BIT_OP
+        NEXT(8);
+    }
+
+    /* Everything else runs through its handler */
+    OP(08) OP(10) OP(76) OP(D9) OP(E8) OP(F8) OP(FB)
+    OP(D3) OP(DB) OP(DD) OP(E3) OP(E4) OP(EB) OP(EC) OP(ED) OP(F4) OP(FC) OP(FD)
+        handler = main_table[op];
+    call_handler: {
+        SAVE_REGISTERS();
+        gb->opcode = op;
+        int taken = handler(gb);
+        LOAD_REGISTERS();
+        if (gb->HALT) {
+            cycles += taken;
+            goto done;
+        }
+        NEXT(taken);
+    }
+
+#if !THREADED_GOTO
+    }
+#endif
+
+done:
+    SAVE_REGISTERS();
+    return last;
+}
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef THREADED_H
+#define THREADED_H
+#include "cpu.h"
+
+/* Run instructions from PC with the registers held in locals until stop_cycle is reached or the CPU
+   halts, skipping idle loops on the way. Returns the address of the last instruction run */
+WORD run_threaded(GameBoy *gb);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef THREADS_H
+#define THREADS_H
+
+/* Threads, locks and condition variables on Windows and POSIX. mutex_trylock() is non-zero if it took
+   the lock. MUTEX_INIT and CONDITION_INIT initialise static ones */
+#ifdef _WIN32
+#include <windows.h>
+typedef HANDLE THREAD;
+typedef SRWLOCK MUTEX;
+typedef CONDITION_VARIABLE CONDITION_VAR;
+#define mutex_init(m) InitializeSRWLock(m)
+#define mutex_destroy(m)
+#define mutex_lock(m) AcquireSRWLockExclusive(m)
+#define mutex_unlock(m) ReleaseSRWLockExclusive(m)
+#define cond_init(c) InitializeConditionVariable(c)
+#define cond_destroy(c)
+#define cond_wait(c, m) SleepConditionVariableSRW(c, m, INFINITE, 0)
+#define cond_broadcast(c) WakeAllConditionVariable(c)
+#define fetch_increment(p) (InterlockedIncrement(p) - 1)
+#define mutex_trylock(m) TryAcquireSRWLockExclusive(m)
+#define MUTEX_INIT SRWLOCK_INIT
+#define CONDITION_INIT CONDITION_VARIABLE_INIT
+#else
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+typedef pthread_t THREAD;
+typedef pthread_mutex_t MUTEX;
+typedef pthread_cond_t CONDITION_VAR;
+#define mutex_init(m) pthread_mutex_init(m, NULL)
+#define mutex_destroy(m) pthread_mutex_destroy(m)
+#define mutex_lock(m) pthread_mutex_lock(m)
+#define mutex_unlock(m) pthread_mutex_unlock(m)
+#define cond_init(c) pthread_cond_init(c, NULL)
+#define cond_destroy(c) pthread_cond_destroy(c)
+#define cond_wait(c, m) pthread_cond_wait(c, m)
+#define cond_broadcast(c) pthread_cond_broadcast(c)
+#define fetch_increment(p) __atomic_fetch_add(p, 1, __ATOMIC_RELAXED)
+#define mutex_trylock(m) (pthread_mutex_trylock(m) == 0)
+#define MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+#define CONDITION_INIT PTHREAD_COND_INITIALIZER
+#endif
+
+#endif
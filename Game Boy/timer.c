@@ -1,4 +1,4 @@
-#include "cpu.h"
+#include "gameboy.h"
 #include "timer.h"
 #include "interrupts.h"
 
@@ -7,59 +7,70 @@ const WORD TIMA = 0xFF05;   // Timer Counter
 const WORD TMA = 0xFF06;    // Timer Modulo
 const WORD TAC = 0xFF07;    // Timer Control
 
-int timer_cycles = 0;
-int divider_cycles = 0;
 
-int timer_clock;
-
-
-
-void timer(int cycles) {
+/* Advance the divider and timer by the number of cycles since the last call. The scheduler calls this
+   at the next tick, so several ticks are only ever handled at once after a long stretch without events */
+void timer(GameBoy *gb, int cycles) {
     
     // Divider is incremented at a rate of 16384 Hz. 256 = cpu speed / frequency 
-    if ((divider_cycles += cycles) >= 256) {
-        divider_cycles = 0;
-        rom[DIV] += 1;
+    gb->divider_cycles += cycles;
+    while (gb->divider_cycles >= 256) {
+        gb->divider_cycles -= 256;
+        gb->rom[DIV] += 1;
     }
     
     // If timer is not enabled, then return
-    if (!timer_enable())
+    if (!timer_enable(gb))
         return;
     
     // Increment the timer by one according to the frequency in the timer control
-    if ((timer_cycles += cycles) >= timer_clock) {
-        rom[TIMA] += 1;
+    set_clock(gb);
+    gb->timer_cycles += cycles;
+    while (gb->timer_cycles >= gb->timer_clock) {
+        gb->timer_cycles -= gb->timer_clock;
+        gb->rom[TIMA] += 1;
         
-        // Once the timer equals 255, request an interrupt, change the timer frequency, and reset the timer to the value in modulo
-        if (rom[TIMA] == 255) {
-            request_interrupt(TIMER);
-            set_clock();
-            rom[TIMA] = rom[TMA];
+        // Once the timer overflows, request an interrupt and reset the timer to the value in modulo
+        if (gb->rom[TIMA] == 0) {
+            request_interrupt(gb, TIMER);
+            gb->rom[TIMA] = gb->rom[TMA];
         }
     }
 }
 
-void set_clock() {
-    switch (rom[TAC] & 0x03) {
+/* Returns the number of cycles until the divider or the timer is next incremented */
+int cycles_until_tick(GameBoy *gb) {
+    int cycles = 256 - gb->divider_cycles;
+
+    if (timer_enable(gb)) {
+        set_clock(gb);
+        if (gb->timer_clock - gb->timer_cycles < cycles)
+            cycles = gb->timer_clock - gb->timer_cycles;
+    }
+    return cycles;
+}
+
+void set_clock(GameBoy *gb) {
+    switch (gb->rom[TAC] & 0x03) {
     // timer clock = clock speed / timer frequency
     case 0x00:  // 4096 Hz
-        timer_clock = 1024;
+        gb->timer_clock = 1024;
         break;
     case 0x01:  // 262144 Hz
-        timer_clock = 16;
+        gb->timer_clock = 16;
         break;
     case 0x02:  // 65536 Hz
-        timer_clock = 64;
+        gb->timer_clock = 64;
         break;  
     case 0x03:  // 16384 Hz
-        timer_clock = 256;
+        gb->timer_clock = 256;
         break;
     }
 }
 
-int timer_enable() {
+int timer_enable(GameBoy *gb) {
     // Check Bit 2 of the timer control to see if clock is enabled
-    if ((rom[TAC] & 0x04) > 0)
+    if ((gb->rom[TAC] & 0x04) > 0)
         return 1;
     else 
         return 0;
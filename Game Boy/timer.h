@@ -1,8 +1,10 @@
 #ifndef TIMER_H
 #define TIMER_H
+#include "cpu.h"
 
-void timer(int cycles);
-void set_clock();
-int timer_enable();
+void timer(GameBoy *gb, int cycles);
+void set_clock(GameBoy *gb);
+int timer_enable(GameBoy *gb);
+int cycles_until_tick(GameBoy *gb);
 
 #endif  TIMER_H
\ No newline at end of file